@@ -6,16 +6,28 @@
  * @details
  * This file contains the main function to demonstrate various tree operations, including 
  * adding nodes, and traversing the tree using different iterators. It also includes 
- * visualization of the tree structure using the SFML library.
+ * visualization of the tree structure using the SFML library. Run with --svg and/or --png to
+ * render a tree to image files without opening a window, optionally reading the tree from a
+ * text file with --input:
+ * 
+ *     Demo [--input tree.txt] [--svg tree.svg] [--png tree.png]
  * 
  * Contact: wasimshebalny@gmail.com
  */
 
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <SFML/Graphics.hpp>
 #include "node.hpp"
 #include "tree.hpp"
 #include "complex.hpp"
+#include "layout.hpp"
+#include "tree_geometry.hpp"
+#include "tree_svg.hpp"
 
 using namespace std;
 
@@ -23,6 +35,10 @@ using namespace std;
 const float NODE_RADIUS = 40.0f;
 const float HORIZONTAL_SPACING = 100.0f;
 const float VERTICAL_SPACING = 100.0f;
+const unsigned TEXT_SIZE = 14;
+const size_t MAX_CHILDREN = 1024;       // Fan-out limit of trees read with --input
+const unsigned MAX_IMAGE_SIZE = 8192;   // Longest side of a --png image in pixels
+const char* const DEMO_TREE = "c\n  a\n    d\n    e\n  b\n    f\n";
 
 /**
  * @brief Load and return the font for drawing text.
@@ -43,72 +59,209 @@ sf::Font& getFont() {
 }
 
 /**
- * @brief Calculate the width of the subtree rooted at the given node.
+ * @class TreeRenderer
+ * @brief Draws a laid-out tree with one vertex array each for edges, discs and labels.
+ * 
+ * Only the nodes inside the window's view are batched, and subtrees smaller than a pixel are
+ * drawn as one solid block. The vertex arrays are rebuilt only when the layout or the view
+ * changes, so an unchanged frame costs three draw calls regardless of the tree's size.
+ * 
+ * @tparam NodeType The node type of the tree.
+ */
+template <typename NodeType>
+class TreeRenderer {
+public:
+    /**
+     * @brief Construct a renderer for a layout.
+     * 
+     * @param layout The layout of the tree, which must outlive the renderer.
+     */
+    explicit TreeRenderer(TreeLayout<NodeType>& layout)
+        : layout(layout), geometry(style()), edges(sf::Lines), discs(sf::Triangles), labels(sf::Triangles) {
+        // One white disc; the vertex colors of the disc batch tint it
+        unsigned size = static_cast<unsigned>(2 * NODE_RADIUS);
+        sf::Image image;
+        image.create(size, size, sf::Color(255, 255, 255, 0));
+        for (unsigned y = 0; y < size; ++y) {
+            for (unsigned x = 0; x < size; ++x) {
+                float dx = x + 0.5f - NODE_RADIUS, dy = y + 0.5f - NODE_RADIUS;
+                float coverage = NODE_RADIUS + 0.5f - sqrt(dx * dx + dy * dy);
+                coverage = coverage < 0 ? 0 : (coverage > 1 ? 1 : coverage);
+                image.setPixel(x, y, sf::Color(255, 255, 255, static_cast<sf::Uint8>(255 * coverage)));
+            }
+        }
+        discTexture.loadFromImage(image);
+        discTexture.setSmooth(true);
+    }
+
+    /**
+     * @brief Draw the tree through the window's current view, rebuilding the vertex arrays
+     * first if the layout or the view changed.
+     * 
+     * @param window The SFML render window or texture.
+     */
+    void draw(sf::RenderTarget &window) {
+        sf::Font& font = getFont();
+        const sf::View& view = window.getView();
+        sf::Vector2f center = view.getCenter(), size = view.getSize();
+        typename TreeGeometry<NodeType>::Viewport visible = {
+            {center.x - size.x / 2, center.y - size.y / 2, center.x + size.x / 2, center.y + size.y / 2},
+            window.getSize().x / size.x
+        };
+        bool rebuilt = geometry.update(layout, visible, [&font](unsigned char c) {
+            const sf::Glyph& glyph = font.getGlyph(c, TEXT_SIZE, false);
+            GlyphMetrics metrics = {
+                glyph.advance, glyph.bounds.left, glyph.bounds.top, glyph.bounds.width, glyph.bounds.height,
+                static_cast<float>(glyph.textureRect.left), static_cast<float>(glyph.textureRect.top),
+                static_cast<float>(glyph.textureRect.width), static_cast<float>(glyph.textureRect.height)
+            };
+            return metrics;
+        });
+        if (rebuilt) {
+            copyVertices(geometry.edges(), edges);
+            copyVertices(geometry.discs(), discs);
+            copyVertices(geometry.labels(), labels);
+        }
+        window.draw(edges);
+        window.draw(discs, sf::RenderStates(&discTexture));
+        window.draw(labels, sf::RenderStates(&font.getTexture(TEXT_SIZE)));
+    }
+
+private:
+    TreeLayout<NodeType>& layout;    ///< The layout being drawn.
+    TreeGeometry<NodeType> geometry; ///< Cached vertex batches.
+    sf::VertexArray edges;           ///< Edge lines.
+    sf::VertexArray discs;           ///< Node disc quads.
+    sf::Texture discTexture;         ///< Texture holding one disc.
+    sf::VertexArray labels;          ///< Label glyph triangles.
+
+    /**
+     * @brief Get the look of the drawn tree.
+     * 
+     * @return TreeGeometry<NodeType>::Style Black discs, white edges and white labels.
+     */
+    static typename TreeGeometry<NodeType>::Style style() {
+        typename TreeGeometry<NodeType>::Style look = {
+            NODE_RADIUS, TEXT_SIZE, {255, 255, 255, 255}, {0, 0, 0, 255}, {255, 255, 255, 255}
+        };
+        return look;
+    }
+
+    /**
+     * @brief Copy a vertex batch into an SFML vertex array.
+     * 
+     * @param from The batch.
+     * @param to The vertex array.
+     */
+    static void copyVertices(const vector<GeometryVertex>& from, sf::VertexArray& to) {
+        to.resize(from.size());
+        for (size_t i = 0; i < from.size(); ++i) {
+            const GeometryVertex& v = from[i];
+            to[i] = sf::Vertex(sf::Vector2f(v.x, v.y), sf::Color(v.color.r, v.color.g, v.color.b, v.color.a),
+                               sf::Vector2f(v.u, v.v));
+        }
+    }
+};
+
+/**
+ * @brief Get the milliseconds elapsed since a start time.
  * 
- * @tparam T The type of data stored in the nodes.
- * @param node Pointer to the root node of the subtree.
- * @return int The width of the subtree.
+ * @param start The start time.
+ * @return double The elapsed time in milliseconds.
  */
-template <typename T>
-int calculateSubtreeWidth(Node<T>* node) {
-    if (!node) return 0;
-    int width = 0;
-    for (auto child : node->children) {
-        width += calculateSubtreeWidth(child);
-    }
-    return max(width, 1); // Ensure each node has at least width 1
+double elapsedMs(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 }
 
 /**
- * @brief Draw the tree recursively starting from the given node.
+ * @brief Render a tree to image files without opening a window, and report the time taken.
  * 
- * @tparam T The type of data stored in the nodes.
- * @param window The SFML render window.
- * @param node Pointer to the current node.
- * @param x The x-coordinate of the node.
- * @param y The y-coordinate of the node.
+ * @param inputPath The text file holding the tree, or empty for the demo tree.
+ * @param svgPath The SVG file to write, or empty for none.
+ * @param pngPath The PNG file to write, or empty for none.
+ * @return int Exit status of the program.
  */
-template <typename T>
-void drawTree(sf::RenderWindow &window, Node<T>* node, float x, float y) {
-    if (!node) return;
-
-    // Draw the node as a circle
-    sf::CircleShape circle(NODE_RADIUS);
-    circle.setFillColor(sf::Color::Black);
-    circle.setPosition(x - NODE_RADIUS, y - NODE_RADIUS);
-    window.draw(circle);
-
-    // Draw the node's value as text
-    sf::Text text;
-    text.setFont(getFont());
-    text.setString(node->toString());
-    text.setCharacterSize(14);
-    text.setFillColor(sf::Color::White);
-    text.setPosition(x - NODE_RADIUS / 2, y - NODE_RADIUS / 2);
-    window.draw(text);
-
-    // Calculate total width of all children
-    int totalWidth = calculateSubtreeWidth(node) * HORIZONTAL_SPACING;
-    float child_x = x - totalWidth / 2 + HORIZONTAL_SPACING / 2;
-    for (auto child : node->children) {
-        if (child) {
-            sf::Vertex line[] = {
-                sf::Vertex(sf::Vector2f(x, y), sf::Color::White),
-                sf::Vertex(sf::Vector2f(child_x, y + VERTICAL_SPACING), sf::Color::White)
-            };
-            window.draw(line, 2, sf::Lines);
-            drawTree(window, child, child_x, y + VERTICAL_SPACING);
-            child_x += calculateSubtreeWidth(child) * HORIZONTAL_SPACING;
+int renderHeadless(const string& inputPath, const string& svgPath, const string& pngPath) {
+    Tree<string, MAX_CHILDREN> tree;
+    auto start = chrono::steady_clock::now();
+    Node<string>* root;
+    if (inputPath.empty()) {
+        istringstream in(DEMO_TREE);
+        root = &tree.read_text(in);
+    } else {
+        ifstream in(inputPath.c_str());
+        if (!in) {
+            cerr << "Could not open " << inputPath << endl;
+            return EXIT_FAILURE;
+        }
+        root = &tree.read_text(in);
+    }
+    cout << "read: " << elapsedMs(start) << " ms" << endl;
+
+    start = chrono::steady_clock::now();
+    TreeLayout<Node<string> > layout(HORIZONTAL_SPACING, VERTICAL_SPACING);
+    layout.build(root, 0, 0);
+    TreeLayout<Node<string> >::Box box = layout.extent(NODE_RADIUS);
+    cout << "layout: " << elapsedMs(start) << " ms" << endl;
+
+    if (!svgPath.empty()) {
+        start = chrono::steady_clock::now();
+        SvgStyle style = {NODE_RADIUS, TEXT_SIZE, "blue", "white", "black", "white"};
+        save_svg(svgPath, layout, style);
+        cout << "svg: " << elapsedMs(start) << " ms" << endl;
+    }
+
+    if (!pngPath.empty()) {
+        // Shrink drawings that do not fit the image size limit
+        start = chrono::steady_clock::now();
+        float width = box.right - box.left, height = box.bottom - box.top;
+        float limit = static_cast<float>(min(MAX_IMAGE_SIZE, sf::Texture::getMaximumSize()));
+        float scale = min(1.0f, limit / max(width, height));
+        sf::RenderTexture target;
+        if (!target.create(max(1u, static_cast<unsigned>(width * scale)), max(1u, static_cast<unsigned>(height * scale)))) {
+            cerr << "Could not create a render texture" << endl;
+            return EXIT_FAILURE;
+        }
+        target.setView(sf::View(sf::FloatRect(box.left, box.top, width, height)));
+        TreeRenderer<Node<string> > renderer(layout);
+        target.clear(sf::Color::Blue);
+        renderer.draw(target);
+        target.display();
+        if (!target.getTexture().copyToImage().saveToFile(pngPath)) {
+            cerr << "Could not write " << pngPath << endl;
+            return EXIT_FAILURE;
         }
+        cout << "png: " << elapsedMs(start) << " ms" << endl;
     }
+    return 0;
 }
 
 /**
  * @brief Main function to demonstrate tree operations and visualizations.
  * 
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
  * @return int Exit status of the program.
  */
-int main() {
+int main(int argc, char* argv[]) {
+    string inputPath, svgPath, pngPath;
+    for (int i = 1; i < argc; i += 2) {
+        string flag = argv[i];
+        if (i + 1 == argc || (flag != "--input" && flag != "--svg" && flag != "--png")) {
+            cerr << "Usage: " << argv[0] << " [--input tree.txt] [--svg tree.svg] [--png tree.png]" << endl;
+            return EXIT_FAILURE;
+        }
+        (flag == "--input" ? inputPath : flag == "--svg" ? svgPath : pngPath) = argv[i + 1];
+    }
+    if (!svgPath.empty() || !pngPath.empty()) {
+        try {
+            return renderHeadless(inputPath, svgPath, pngPath);
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     // Test the == operator for Complex numbers
     Complex c1(1.1, 2.2);
     Complex c2(1.1, 2.2);
@@ -122,17 +275,26 @@ int main() {
     Tree<string> tree;
     tree.add_root(root_node);
 
+    // The layout is computed once and updated along the insertion path for each new node
+    TreeLayout<Node<string> > layout(HORIZONTAL_SPACING, VERTICAL_SPACING);
+    layout.build(&root_node, 0, 50);
+    auto add_node = [&tree, &layout](Node<string>& parent, Node<string>& child) {
+        if (Node<string>* attached_to = tree.add_sub_node(parent, child)) {
+            layout.attach(*attached_to, child);
+        }
+    };
+
     Node<string> n1("a");
     Node<string> n2("b");
     Node<string> n3("d");
     Node<string> n4("e");
     Node<string> n5("f");
 
-    tree.add_sub_node(root_node, n1);
-    tree.add_sub_node(root_node, n2);
-    tree.add_sub_node(n1, n3);
-    tree.add_sub_node(n1, n4);
-    tree.add_sub_node(n2, n5);
+    add_node(root_node, n1);
+    add_node(root_node, n2);
+    add_node(n1, n3);
+    add_node(n1, n4);
+    add_node(n2, n5);
 
     // Test the BFS iterator
     cout << "BFS traversal: ";
@@ -176,18 +338,50 @@ int main() {
     }
     cout << endl;
 
-    // Set up SFML window for tree visualization
+    // Set up SFML window for tree visualization; drag to pan, scroll to zoom
     sf::RenderWindow window(sf::VideoMode(1000, 600), "Tree Visualization");
+    layout.set_origin(window.getSize().x / 2, 50);
+    TreeRenderer<Node<string> > renderer(layout);
+    sf::View view = window.getDefaultView();
+    float zoom = 1.0f;
+    bool dragging = false;
+    sf::Vector2i dragFrom;
 
     while (window.isOpen()) {
         sf::Event event;
         while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
+            if (event.type == sf::Event::Closed) {
                 window.close();
+            } else if (event.type == sf::Event::Resized) {
+                view.setSize(event.size.width * zoom, event.size.height * zoom);
+            } else if (event.type == sf::Event::MouseWheelScrolled) {
+                // Zoom about the cursor: keep the point under it in place
+                sf::Vector2i pixel(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                sf::Vector2f before = window.mapPixelToCoords(pixel);
+                float factor = event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f;
+                zoom *= factor;
+                view.zoom(factor);
+                window.setView(view);
+                sf::Vector2f after = window.mapPixelToCoords(pixel);
+                view.move(before.x - after.x, before.y - after.y);
+            } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+                dragging = true;
+                dragFrom = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            } else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+                dragging = false;
+            } else if (event.type == sf::Event::MouseMoved && dragging) {
+                sf::Vector2i dragTo(event.mouseMove.x, event.mouseMove.y);
+                sf::Vector2f from = window.mapPixelToCoords(dragFrom);
+                sf::Vector2f to = window.mapPixelToCoords(dragTo);
+                view.move(from.x - to.x, from.y - to.y);
+                window.setView(view);
+                dragFrom = dragTo;
+            }
         }
+        window.setView(view);
 
         window.clear(sf::Color::Blue);
-        drawTree(window, &root_node, window.getSize().x / 2, 50);
+        renderer.draw(window);
         window.display();
     }
 
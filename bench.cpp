@@ -0,0 +1,922 @@
+/**
+ * @file bench.cpp
+ * @brief Benchmarks for the Tree class.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains timing benchmarks for tree operations: bulk tree construction through
+ * add_sub_node with parents resolved by find_node against the key index, and build plus
+ * teardown of individually heap-allocated nodes against tree-owned arena nodes, and traversal of
+ * vector-backed nodes against nodes with inline child arrays. It also reports the memory used
+ * per node by each node layout on a wide, sparse tree, and times "smallest 100 keys" queries
+ * through MinHeapIterator, Tree::smallest and the frontier traversal. Finally it compares the
+ * stack-based pre-order and post-order iterators with the stackless ones on parent-linked nodes,
+ * the BFS and DFS iterators with the same traversals over a frozen snapshot, and find_node with
+ * scalar and vectorized scans over columnar keys. The last tables show how parallel_for_each
+ * and reduce scale from one worker up to every hardware thread.
+ *
+ * Usage: bench_tree [max_nodes]
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "node.hpp"
+#include "tree.hpp"
+#include "columnar_keys.hpp"
+#include "complex.hpp"
+#include "tree_file.hpp"
+#include "layout.hpp"
+#include "tree_geometry.hpp"
+#include "tree_svg.hpp"
+#include "generator.hpp"
+
+using namespace std;
+
+/**
+ * @brief Return the elapsed time since the given point in milliseconds.
+ *
+ * @param start The starting time point.
+ * @return double The elapsed time in milliseconds.
+ */
+static double elapsed_ms(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Describe a complete tree whose keys are the node numbers in breadth-first order.
+ *
+ * @param n The number of nodes.
+ * @param arity The number of children per inner node.
+ * @return TreeSpec The spec.
+ */
+static TreeSpec complete_tree(size_t n, size_t arity) {
+    TreeSpec spec = TreeSpec::complete(n, arity);
+    spec.keys = KeyOrder::Ascending;
+    return spec;
+}
+
+/**
+ * @brief Build a complete k-ary tree of n nodes through add_sub_node and time it.
+ *
+ * Node i is attached to parent (i - 1) / k, so the last inserted parents are the deepest
+ * and rightmost ones, which is the worst case for find_node.
+ *
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @param indexed Whether to enable the key index before building.
+ * @return double The build time in milliseconds.
+ */
+template <int k>
+static double build_complete(size_t n, bool indexed) {
+    vector<Node<int> > nodes;
+    nodes.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        nodes.push_back(Node<int>(static_cast<int>(i)));
+    }
+
+    auto start = chrono::steady_clock::now();
+    Tree<int, k> tree;
+    if (indexed) tree.enable_key_index();
+    tree.add_root(nodes[0]);
+    for (size_t i = 1; i < n; ++i) {
+        tree.add_sub_node(nodes[(i - 1) / k], nodes[i]);
+    }
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Build a complete k-ary tree in one call from a parent-index array.
+ *
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @return double The build time in milliseconds, excluding the input arrays.
+ */
+template <int k>
+static double build_parents(size_t n) {
+    vector<int> keys(n);
+    vector<long> parents(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(i);
+        parents[i] = i == 0 ? -1 : static_cast<long>((i - 1) / k);
+    }
+
+    auto start = chrono::steady_clock::now();
+    Tree<int, k> tree;
+    tree.build_from_parents(keys, parents);
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Build a complete k-ary tree by streaming its pre-order (key, child count) pairs.
+ *
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @return double The build time in milliseconds, excluding the input sequence.
+ */
+template <int k>
+static double build_pre_order(size_t n) {
+    vector<pair<int, size_t> > stream;
+    stream.reserve(n);
+    vector<size_t> pending(1, 0);
+    while (!pending.empty()) {
+        size_t i = pending.back();
+        pending.pop_back();
+        size_t first = i * k + 1;
+        size_t last = min(first + k, n);
+        stream.push_back(make_pair(static_cast<int>(i), first < n ? last - first : 0));
+        for (size_t child = last; child > first; --child) pending.push_back(child - 1);
+    }
+
+    auto start = chrono::steady_clock::now();
+    Tree<int, k> tree;
+    tree.build_from_pre_order(stream.begin(), stream.end());
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Build and destroy a complete k-ary tree of individually heap-allocated nodes.
+ *
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @return double The build and teardown time in milliseconds.
+ */
+template <int k>
+static double build_heap_nodes(size_t n) {
+    auto start = chrono::steady_clock::now();
+    vector<Node<int>*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(new Node<int>(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(new Node<int>(static_cast<int>(i)));
+        nodes[(i - 1) / k]->add_child(nodes[i]);
+    }
+    Tree<int, k> tree;
+    tree.add_root(*nodes[0]);
+    for (auto node : nodes) delete node;
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Build and destroy a complete k-ary tree of tree-owned arena nodes.
+ *
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @return double The build and teardown time in milliseconds.
+ */
+template <int k>
+static double build_arena_nodes(size_t n) {
+    auto start = chrono::steady_clock::now();
+    {
+        Tree<int, k> tree;
+        vector<Node<int>*> nodes;
+        nodes.reserve(n);
+        nodes.push_back(&tree.emplace_root(0));
+        for (size_t i = 1; i < n; ++i) {
+            nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / k], static_cast<int>(i)));
+        }
+    }
+    return elapsed_ms(start);
+}
+
+/**
+ * @brief Build a complete k-ary arena tree and time a full DFS traversal over it.
+ *
+ * @tparam TreeType The tree type, which selects the node layout.
+ * @tparam k The maximum number of children per node.
+ * @param n The number of nodes.
+ * @return double The traversal time in milliseconds.
+ */
+template <typename TreeType, int k>
+static double traverse_dfs(size_t n) {
+    typedef typename TreeType::node_type NodeType;
+    TreeType tree;
+    vector<NodeType*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / k], static_cast<int>(i)));
+    }
+
+    auto start = chrono::steady_clock::now();
+    long long sum = 0;
+    for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) {
+        sum += it->get_key();
+    }
+    double ms = elapsed_ms(start);
+    if (sum < 0) cout << sum;
+    return ms;
+}
+
+/**
+ * @brief Build a wide, sparse tree and return its memory use per node.
+ *
+ * Nodes are expanded breadth-first and get 0 to 3 children each (at least one while the
+ * frontier would otherwise run dry), far below the fan-out limit.
+ *
+ * @tparam TreeType The tree type, which selects the node layout.
+ * @param n The number of nodes.
+ * @return double The memory use in bytes per node.
+ */
+template <typename TreeType>
+static double bytes_per_node(size_t n) {
+    typedef typename TreeType::node_type NodeType;
+    TreeType tree;
+    vector<NodeType*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    unsigned long long state = 12345;
+    for (size_t parent = 0; nodes.size() < n; ++parent) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t fan_out = static_cast<size_t>(state >> 62);
+        if (parent + 1 == nodes.size() && fan_out == 0) fan_out = 1;
+        for (size_t c = 0; c < fan_out && nodes.size() < n; ++c) {
+            nodes.push_back(tree.emplace_sub_node(*nodes[parent], static_cast<int>(nodes.size())));
+        }
+    }
+    return static_cast<double>(tree.memory_usage()) / n;
+}
+
+/**
+ * @brief Time a "smallest m keys" query three ways on a heap-ordered complete binary tree.
+ *
+ * @param n The number of nodes.
+ * @param m The number of keys to fetch.
+ * @param times Receives the MinHeapIterator, smallest and frontier times in milliseconds.
+ */
+static void smallest_keys(size_t n, size_t m, double times[3]) {
+    Tree<int, 2> tree;
+    vector<Node<int>*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / 2], static_cast<int>(i)));
+    }
+
+    long long sum = 0;
+    auto start = chrono::steady_clock::now();
+    size_t taken = 0;
+    for (auto it = tree.begin_min_heap(); it != tree.end_min_heap() && taken < m; ++it, ++taken) {
+        sum += it->get_key();
+    }
+    times[0] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    for (auto node : tree.smallest(m)) sum += node->get_key();
+    times[1] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    taken = 0;
+    for (auto it = tree.begin_frontier(); it != tree.end_frontier() && taken < m; ++it, ++taken) {
+        sum += it->get_key();
+    }
+    times[2] = elapsed_ms(start);
+    if (sum < 0) cout << sum;
+}
+
+/**
+ * @brief Sum all keys through an iterator range and return the time taken.
+ *
+ * @param it The iterator to the beginning of the traversal.
+ * @param end The iterator to the end of the traversal.
+ * @return double The traversal time in milliseconds.
+ */
+template <typename Iterator>
+static double time_traversal(Iterator it, Iterator end) {
+    auto start = chrono::steady_clock::now();
+    long long sum = 0;
+    for (; it != end; ++it) sum += it->get_key();
+    double ms = elapsed_ms(start);
+    if (sum < 0) cout << sum;
+    return ms;
+}
+
+/**
+ * @brief Time stack-based and stackless traversals of a complete 64-ary parent-linked tree.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the pre-order, stackless pre-order, post-order and stackless
+ * post-order times in milliseconds.
+ */
+static void stackless_traversals(size_t n, double times[4]) {
+    ParentTree<int, 64> tree;
+    vector<ParentNode<int>*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / 64], static_cast<int>(i)));
+    }
+    times[0] = time_traversal(tree.begin_pre_order(), tree.end_pre_order());
+    times[1] = time_traversal(tree.begin_stackless_pre_order(), tree.end_stackless_pre_order());
+    times[2] = time_traversal(tree.begin_post_order(), tree.end_post_order());
+    times[3] = time_traversal(tree.begin_stackless_post_order(), tree.end_stackless_post_order());
+}
+
+/**
+ * @brief Time many back-to-back traversals of a small tree, each starting a new iterator.
+ *
+ * @param repeats The number of traversals.
+ * @param start_traversal Starts one traversal and returns the sum of its keys.
+ * @return double The time per traversal in microseconds.
+ */
+template <typename Start>
+static double time_repeated(size_t repeats, Start start_traversal) {
+    auto start = chrono::steady_clock::now();
+    long long sum = 0;
+    for (size_t r = 0; r < repeats; ++r) sum += start_traversal();
+    double us = elapsed_ms(start) * 1000 / repeats;
+    if (sum < 0) cout << sum;
+    return us;
+}
+
+/**
+ * @brief Time repeated BFS and DFS traversals of a complete 4-ary tree with and without a
+ * reused scratch.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the BFS, scratch BFS, DFS and scratch DFS times per traversal in
+ * microseconds.
+ */
+static void repeated_traversals(size_t n, double times[4]) {
+    typedef Tree<int, 4> BenchTree;
+    BenchTree tree;
+    generate_tree(tree, complete_tree(n, 4));
+    BenchTree::TraversalScratch scratch;
+    tree.presize_scratch(scratch);
+    size_t repeats = max<size_t>(100, 2000000 / n);
+    auto sum = [](BenchTree::BFSIterator it, BenchTree::BFSIterator end) {
+        long long total = 0;
+        for (; it != end; ++it) total += it->get_key();
+        return total;
+    };
+    auto dfs_sum = [](BenchTree::DFSIterator it, BenchTree::DFSIterator end) {
+        long long total = 0;
+        for (; it != end; ++it) total += it->get_key();
+        return total;
+    };
+    times[0] = time_repeated(repeats, [&]() { return sum(tree.begin_bfs(), tree.end_bfs()); });
+    times[1] = time_repeated(repeats, [&]() { return sum(tree.begin_bfs(scratch), tree.end_bfs()); });
+    times[2] = time_repeated(repeats, [&]() { return dfs_sum(tree.begin_dfs(), tree.end_dfs()); });
+    times[3] = time_repeated(repeats, [&]() { return dfs_sum(tree.begin_dfs(scratch), tree.end_dfs()); });
+}
+
+/**
+ * @brief Sum all keys of a frozen snapshot in the given order and return the time taken.
+ *
+ * @param frozen The snapshot.
+ * @param order The traversal order.
+ * @return double The traversal time in milliseconds.
+ */
+static double time_frozen(const FrozenTree<int>& frozen, Traversal order) {
+    auto start = chrono::steady_clock::now();
+    long long sum = 0;
+    frozen.for_each(order, [&sum](const int& key) { sum += key; });
+    double ms = elapsed_ms(start);
+    if (sum < 0) cout << sum;
+    return ms;
+}
+
+/**
+ * @brief Time BFS and DFS over a complete 4-ary tree and over its frozen snapshot.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the BFS, frozen BFS, DFS and frozen DFS times in milliseconds.
+ */
+static void frozen_traversals(size_t n, double times[4]) {
+    Tree<int, 4> tree;
+    vector<Node<int>*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / 4], static_cast<int>(i)));
+    }
+    FrozenTree<int> frozen = tree.freeze();
+    times[0] = time_traversal(tree.begin_bfs(), tree.end_bfs());
+    times[1] = time_frozen(frozen, Traversal::BFS);
+    times[2] = time_traversal(tree.begin_dfs(), tree.end_dfs());
+    times[3] = time_frozen(frozen, Traversal::DFS);
+}
+
+/**
+ * @brief Time storing a complete 4-ary tree and loading it back, as text and as a mapped file.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the save, map and first BFS times of the binary file and the time to
+ * rebuild the tree from pre-order text, in milliseconds.
+ */
+static void tree_file_round_trip(size_t n, double times[4]) {
+    Tree<int, 4> tree;
+    generate_tree(tree, complete_tree(n, 4));
+    const string path = "bench_tree_file.bin";
+
+    auto start = chrono::steady_clock::now();
+    save_tree_file(path, tree.freeze());
+    times[0] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    {
+        MappedTree<int> mapped(path);
+        times[1] = elapsed_ms(start);
+        start = chrono::steady_clock::now();
+        long long sum = 0;
+        mapped.for_each(Traversal::BFS, [&sum](const int& key) { sum += key; });
+        times[2] = elapsed_ms(start);
+        if (sum < 0) cout << sum;
+    }
+    remove(path.c_str());
+
+    ostringstream text;
+    for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) {
+        text << it->get_key() << ' ' << it->children.size() << '\n';
+    }
+    istringstream in(text.str());
+    start = chrono::steady_clock::now();
+    Tree<int, 4> loaded;
+    loaded.read_pre_order(in);
+    times[3] = elapsed_ms(start);
+}
+
+/**
+ * @brief Print a subtree the way operator<< did before it became iterative and buffered.
+ *
+ * @param os The output stream.
+ * @param node The current node.
+ * @param depth The current depth for indentation.
+ */
+static void print_recursive(ostream& os, Node<int>* node, int depth) {
+    for (int i = 0; i < depth; ++i) {
+        os << "  ";
+    }
+    os << node->get_key() << "\n";
+    for (auto child : node->children) {
+        print_recursive(os, child, depth + 1);
+    }
+}
+
+/**
+ * @brief Time writing a complete 4-ary tree as text and reading it back.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the recursive print, operator<< and read_text times in milliseconds.
+ */
+static void text_round_trip(size_t n, double times[3]) {
+    Tree<int, 4> tree;
+    Node<int>& root = generate_tree(tree, complete_tree(n, 4));
+
+    ostringstream recursive;
+    auto start = chrono::steady_clock::now();
+    print_recursive(recursive, &root, 0);
+    times[0] = elapsed_ms(start);
+
+    ostringstream buffered;
+    start = chrono::steady_clock::now();
+    buffered << tree;
+    times[1] = elapsed_ms(start);
+
+    istringstream in(buffered.str());
+    start = chrono::steady_clock::now();
+    Tree<int, 4> parsed;
+    parsed.read_text(in);
+    times[2] = elapsed_ms(start);
+}
+
+/**
+ * @brief Time formatting keys as text, in nanoseconds per key.
+ *
+ * @param keys The keys to format.
+ * @param times Receives the stringstream, toString, append_key and format_key times.
+ */
+template <typename T>
+static void format_keys(const vector<T>& keys, double times[4]) {
+    size_t total = 0;
+    double scale = 1e6 / keys.size();
+
+    auto start = chrono::steady_clock::now();
+    for (const T& key : keys) {
+        stringstream ss;
+        ss << key;
+        total += ss.str().size();
+    }
+    times[0] = elapsed_ms(start) * scale;
+
+    start = chrono::steady_clock::now();
+    for (const T& key : keys) total += Node<T>(key).toString().size();
+    times[1] = elapsed_ms(start) * scale;
+
+    string text;
+    start = chrono::steady_clock::now();
+    for (const T& key : keys) {
+        text.clear();
+        append_key(text, key);
+        total += text.size();
+    }
+    times[2] = elapsed_ms(start) * scale;
+
+    char buffer[64];
+    start = chrono::steady_clock::now();
+    for (const T& key : keys) total += format_key(buffer, buffer + sizeof(buffer), key) - buffer;
+    times[3] = elapsed_ms(start) * scale;
+    if (total == 0) cout << total;
+}
+
+/**
+ * @brief Compute a subtree width recursively, as the demo did for every node of every frame.
+ *
+ * @param node The subtree root.
+ * @return int The width in slots.
+ */
+static int subtree_width(Node<int>* node) {
+    int width = 0;
+    for (auto child : node->children) width += subtree_width(child);
+    return max(width, 1);
+}
+
+/**
+ * @brief Place a subtree the way the demo's recursive drawTree did, without drawing.
+ *
+ * @param node The subtree root.
+ * @param x The horizontal position of the root.
+ * @param y The vertical position of the root.
+ * @param sum Accumulates the positions so the work is not optimized away.
+ */
+static void place_recursive(Node<int>* node, float x, float y, double& sum) {
+    sum += x + y;
+    int total_width = subtree_width(node) * 100;
+    float child_x = x - total_width / 2 + 50;
+    for (auto child : node->children) {
+        place_recursive(child, child_x, y + 100, sum);
+        child_x += subtree_width(child) * 100;
+    }
+}
+
+/**
+ * @brief Time computing node positions for one frame and with the layout cache.
+ *
+ * @param n The number of nodes of a complete 4-ary tree.
+ * @param times Receives the recursive per-frame time, the full layout build, the time to attach
+ * the last 1% of the nodes incrementally, a cached frame, building the vertex batches of the
+ * whole tree, and, after panning, of a 1000x600 view at full size and of the whole tree shrunk
+ * to 1000 pixels, in milliseconds.
+ */
+static void layout_times(size_t n, double times[7]) {
+    Tree<int, 4> tree;
+    Node<int>& root = generate_tree(tree, complete_tree(n, 4));
+    double sum = 0;
+
+    auto start = chrono::steady_clock::now();
+    place_recursive(&root, 500, 50, sum);
+    times[0] = elapsed_ms(start);
+
+    TreeLayout<Node<int> > layout(100, 100);
+    start = chrono::steady_clock::now();
+    layout.build(&root, 500, 50);
+    layout.position(root);
+    times[1] = elapsed_ms(start);
+
+    vector<Node<int>*> by_index;
+    for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) by_index.push_back(&*it);
+    size_t extra = max<size_t>(n / 100, 1);
+    vector<Node<int> > added;
+    added.reserve(extra);
+    for (size_t i = 0; i < extra; ++i) added.push_back(Node<int>(static_cast<int>(n + i)));
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < extra; ++i) {
+        Node<int>& leaf = *by_index[n - 1 - i];
+        leaf.add_child(&added[i]);
+        layout.attach(leaf, added[i]);
+    }
+    layout.position(root);
+    times[2] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    layout.for_each([&sum](Node<int>&, const TreeLayout<Node<int> >::Point& p, const TreeLayout<Node<int> >::Point&) {
+        sum += p.x + p.y;
+    });
+    times[3] = elapsed_ms(start);
+
+    TreeGeometry<Node<int> >::Style style = {40, 14, {255, 255, 255, 255}, {0, 0, 0, 255}, {255, 255, 255, 255}};
+    TreeGeometry<Node<int> > geometry(style);
+    auto glyph = [](unsigned char c) {
+        GlyphMetrics m = {8, 1, -10, 6, 10, static_cast<float>(c) * 8, 0, 6, 10};
+        return m;
+    };
+    // Time a rebuild after the tree moved, once the batches have reached their full size
+    geometry.update(layout, glyph);
+    layout.set_origin(1, 0);
+    start = chrono::steady_clock::now();
+    geometry.update(layout, glyph);
+    times[4] = elapsed_ms(start);
+
+    TreeLayout<Node<int> >::Point centre = layout.position(root);
+    TreeGeometry<Node<int> >::Viewport window = {{centre.x - 500, centre.y - 50, centre.x + 500, centre.y + 550}, 1};
+    start = chrono::steady_clock::now();
+    geometry.update(layout, window, glyph);
+    times[5] = elapsed_ms(start);
+
+    TreeGeometry<Node<int> >::Viewport whole = {{-1e9f, -1e9f, 1e9f, 1e9f}, 1000.0f / (n * 100.0f)};
+    start = chrono::steady_clock::now();
+    geometry.update(layout, whole, glyph);
+    times[6] = elapsed_ms(start);
+    if (sum == 0.5) cout << sum;
+}
+
+/**
+ * @brief Time laying out a complete 4-ary tree and drawing it as SVG, as a headless render does.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the layout and SVG times in milliseconds and the SVG size in megabytes.
+ */
+static void headless_render(size_t n, double times[3]) {
+    Tree<int, 4> tree;
+    Node<int>& root = generate_tree(tree, complete_tree(n, 4));
+
+    auto start = chrono::steady_clock::now();
+    TreeLayout<Node<int> > layout(100, 100);
+    layout.build(&root, 0, 0);
+    layout.extent(40);
+    times[0] = elapsed_ms(start);
+
+    ostringstream svg;
+    SvgStyle style = {40, 14, "blue", "white", "black", "white"};
+    start = chrono::steady_clock::now();
+    write_svg(svg, layout, style);
+    times[1] = elapsed_ms(start);
+    times[2] = svg.str().size() / 1e6;
+}
+
+/**
+ * @brief Time key searches and reductions over a complete 4-ary tree.
+ *
+ * The searched key is the last one added, the worst case for both find_node and the scans.
+ *
+ * @param n The number of nodes.
+ * @param times Receives the find_node, scalar find, columnar find, scalar min and columnar
+ * min times in milliseconds.
+ */
+static void key_scans(size_t n, double times[5]) {
+    Tree<int, 4> tree;
+    vector<Node<int>*> nodes;
+    nodes.reserve(n);
+    nodes.push_back(&tree.emplace_root(0));
+    for (size_t i = 1; i < n; ++i) {
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / 4], static_cast<int>(i)));
+    }
+    FrozenTree<int> frozen = tree.freeze();
+    ColumnarKeys<int> columns = frozen.columns();
+    const vector<int>& keys = frozen.keys();
+    Node<int> target(static_cast<int>(n - 1));
+    size_t found = 0;
+    int smallest = 0;
+
+    auto start = chrono::steady_clock::now();
+    found += tree.find_node(nodes[0], target) != nullptr;
+    times[0] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == target.get_key()) {
+            found += i;
+            break;
+        }
+    }
+    times[1] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    found += columns.find(target.get_key());
+    times[2] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    smallest += columnar_detail::min<int>(keys.data(), keys.size());
+    times[3] = elapsed_ms(start);
+
+    start = chrono::steady_clock::now();
+    smallest += columns.min();
+    times[4] = elapsed_ms(start);
+    if (found == 0 || smallest < 0) cout << found << smallest;
+}
+
+/**
+ * @brief Time parallel_for_each with a small amount of work per node on a given pool.
+ *
+ * @param tree The tree to walk.
+ * @param threads The number of pool workers.
+ * @return double The walk time in milliseconds.
+ */
+static double time_parallel(const Tree<int, 4>& tree, size_t threads) {
+    WorkStealingPool pool(threads);
+    atomic<unsigned long long> total(0);
+    auto start = chrono::steady_clock::now();
+    tree.parallel_for_each(Traversal::PreOrder, [&total](Node<int>& node) {
+        unsigned long long h = static_cast<unsigned long long>(node.get_key());
+        for (int i = 0; i < 200; ++i) h = h * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (h == 0) total.fetch_add(1);
+    }, pool);
+    double ms = elapsed_ms(start);
+    if (total.load() == 12345) cout << total.load();
+    return ms;
+}
+
+/**
+ * @brief Time a parallel sum of all keys on a given pool.
+ *
+ * @param tree The tree to reduce.
+ * @param threads The number of pool workers, or 0 for a serial BFS loop.
+ * @return double The reduction time in milliseconds.
+ */
+static double time_reduce(const Tree<int, 4>& tree, size_t threads) {
+    long long sum = 0;
+    auto start = chrono::steady_clock::now();
+    if (threads == 0) {
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) sum += it->get_key();
+        double ms = elapsed_ms(start);
+        if (sum < 0) cout << sum;
+        return ms;
+    }
+    WorkStealingPool pool(threads);
+    start = chrono::steady_clock::now();
+    sum = tree.reduce(0LL, [](long long a, long long b) { return a + b; }, pool);
+    double ms = elapsed_ms(start);
+    if (sum < 0) cout << sum;
+    return ms;
+}
+
+/**
+ * @brief Run the benchmarks.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments; the optional first argument is the largest tree size.
+ * @return int Exit status of the program.
+ */
+int main(int argc, char* argv[]) {
+    size_t max_nodes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+
+    cout << "bulk build, complete binary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "find_node" << setw(14) << "key index" << setw(14) << "parents" << setw(14) << "pre-order" << endl;
+    for (size_t n = 1000; n <= max_nodes; n *= 2) {
+        cout << setw(10) << n
+             << setw(14) << fixed << setprecision(2) << build_complete<2>(n, false)
+             << setw(14) << build_complete<2>(n, true)
+             << setw(14) << build_parents<2>(n)
+             << setw(14) << build_pre_order<2>(n) << endl;
+    }
+
+    cout << endl << "build + teardown, complete binary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "heap nodes" << setw(14) << "arena" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        cout << setw(10) << n
+             << setw(14) << build_heap_nodes<2>(n)
+             << setw(14) << build_arena_nodes<2>(n) << endl;
+    }
+
+    cout << endl << "DFS traversal, complete 4-ary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "vector" << setw(14) << "inline" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        cout << setw(10) << n
+             << setw(14) << traverse_dfs<Tree<int, 4>, 4>(n)
+             << setw(14) << traverse_dfs<InlineTree<int, 4>, 4>(n) << endl;
+    }
+
+    size_t sparse_nodes = max_nodes * 16;
+    cout << endl << "memory per node, k = 64, 0-3 children per node (bytes)" << endl;
+    cout << setw(20) << "Node<int>" << setw(14) << bytes_per_node<Tree<int, 64> >(sparse_nodes) << endl;
+    cout << setw(20) << "Node<int, 64>" << setw(14) << bytes_per_node<InlineTree<int, 64> >(sparse_nodes) << endl;
+    cout << setw(20) << "SiblingNode<int>" << setw(14) << bytes_per_node<SiblingTree<int, 64> >(sparse_nodes) << endl;
+
+    cout << endl << "smallest 100 keys, heap-ordered binary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "min-heap it" << setw(14) << "smallest" << setw(14) << "frontier" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[3];
+        smallest_keys(n, 100, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2] << endl;
+    }
+
+    cout << endl << "traversal, complete 64-ary parent-linked tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "pre-order" << setw(14) << "stackless" << setw(14) << "post-order" << setw(14) << "stackless" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[4];
+        stackless_traversals(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2] << setw(14) << times[3] << endl;
+    }
+
+    cout << endl << "traversal, complete 4-ary tree vs frozen snapshot (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "BFS" << setw(14) << "frozen BFS" << setw(14) << "DFS" << setw(14) << "frozen DFS" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[4];
+        frozen_traversals(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2] << setw(14) << times[3] << endl;
+    }
+
+    cout << endl << "repeated traversal, complete 4-ary tree (us per traversal)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "BFS" << setw(14) << "scratch BFS" << setw(14) << "DFS"
+         << setw(14) << "scratch DFS" << endl;
+    for (size_t n = 16; n <= 16384; n *= 4) {
+        double times[4];
+        repeated_traversals(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2]
+             << setw(14) << times[3] << endl;
+    }
+
+    cout << endl << "store and load, complete 4-ary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "save" << setw(14) << "map" << setw(14) << "mapped BFS"
+         << setw(14) << "text load" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[4];
+        tree_file_round_trip(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2]
+             << setw(14) << times[3] << endl;
+    }
+
+    cout << endl << "text output and parse-back, complete 4-ary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "recursive" << setw(14) << "operator<<" << setw(14) << "read_text" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[3];
+        text_round_trip(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2] << endl;
+    }
+
+    size_t format_count = max_nodes * 16;
+    vector<int> int_keys(format_count);
+    vector<double> double_keys(format_count);
+    vector<Complex> complex_keys(format_count);
+    for (size_t i = 0; i < format_count; ++i) {
+        int_keys[i] = static_cast<int>(i * 2654435761u);
+        double_keys[i] = static_cast<double>(i) / 7.0;
+        complex_keys[i] = Complex(static_cast<double>(i) / 3.0, -static_cast<double>(i));
+    }
+    cout << endl << "key formatting (ns per key)" << endl;
+    cout << setw(10) << "key" << setw(14) << "stringstream" << setw(14) << "toString" << setw(14) << "append_key"
+         << setw(14) << "format_key" << endl;
+    double format_times[4];
+    format_keys(int_keys, format_times);
+    cout << setw(10) << "int" << setw(14) << format_times[0] << setw(14) << format_times[1] << setw(14) << format_times[2]
+         << setw(14) << format_times[3] << endl;
+    format_keys(double_keys, format_times);
+    cout << setw(10) << "double" << setw(14) << format_times[0] << setw(14) << format_times[1] << setw(14) << format_times[2]
+         << setw(14) << format_times[3] << endl;
+    format_keys(complex_keys, format_times);
+    cout << setw(10) << "Complex" << setw(14) << format_times[0] << setw(14) << format_times[1] << setw(14) << format_times[2]
+         << setw(14) << format_times[3] << endl;
+
+    cout << endl << "layout, complete 4-ary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "recursive" << setw(14) << "build" << setw(14) << "attach 1%"
+         << setw(14) << "cached frame" << setw(14) << "geometry" << setw(14) << "in view" << setw(14) << "zoomed out"
+         << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[7];
+        layout_times(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2]
+             << setw(14) << times[3] << setw(14) << times[4] << setw(14) << times[5] << setw(14) << times[6] << endl;
+    }
+
+    cout << endl << "headless render, complete 4-ary tree" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "layout ms" << setw(14) << "svg ms" << setw(14) << "svg MB" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[3];
+        headless_render(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2] << endl;
+    }
+
+    cout << endl << "key scans, complete 4-ary tree (ms)" << endl;
+    cout << setw(10) << "nodes" << setw(14) << "find_node" << setw(14) << "scalar find" << setw(14) << "simd find"
+         << setw(14) << "scalar min" << setw(14) << "simd min" << endl;
+    for (size_t n = 1000; n <= max_nodes * 64; n *= 4) {
+        double times[5];
+        key_scans(n, times);
+        cout << setw(10) << n << setw(14) << times[0] << setw(14) << times[1] << setw(14) << times[2]
+             << setw(14) << times[3] << setw(14) << times[4] << endl;
+    }
+
+    size_t parallel_nodes = max_nodes * 64;
+    Tree<int, 4> parallel_tree;
+    vector<Node<int>*> parallel_nodes_list;
+    parallel_nodes_list.reserve(parallel_nodes);
+    parallel_nodes_list.push_back(&parallel_tree.emplace_root(0));
+    for (size_t i = 1; i < parallel_nodes; ++i) {
+        parallel_nodes_list.push_back(parallel_tree.emplace_sub_node(*parallel_nodes_list[(i - 1) / 4], static_cast<int>(i)));
+    }
+    size_t hardware = thread::hardware_concurrency();
+    if (hardware == 0) hardware = 1;
+    cout << endl << "parallel_for_each, complete 4-ary tree of " << parallel_nodes << " nodes (ms)" << endl;
+    cout << setw(10) << "threads" << setw(14) << "for_each" << setw(14) << "speedup" << setw(14) << "reduce" << endl;
+    cout << setw(10) << "serial" << setw(14) << "" << setw(14) << "" << setw(14) << time_reduce(parallel_tree, 0) << endl;
+    double single = 0;
+    for (size_t threads = 1; threads <= hardware; threads *= 2) {
+        double ms = time_parallel(parallel_tree, threads);
+        if (threads == 1) single = ms;
+        cout << setw(10) << threads << setw(14) << ms << setw(14) << single / ms
+             << setw(14) << time_reduce(parallel_tree, threads) << endl;
+        if (threads < hardware && threads * 2 > hardware) threads = hardware / 2;
+    }
+    return 0;
+}
@@ -0,0 +1,425 @@
+/**
+ * @file bench_suite.cpp
+ * @brief Benchmark suite timing every Tree operation across tree shapes and sizes.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains a self-contained benchmark harness that times add_sub_node (through the
+ * key index and through find_node), find_node, the six iterators, operator<< and the layout
+ * used by the visualizer. Each operation runs on four tree shapes (a chain, a complete 4-ary
+ * tree, a random recursive tree and a star) at sizes from 10^3 up to 10^7 nodes, and every
+ * measurement is printed as one CSV line or JSON object for scripts and dashboards. The trees
+ * come from the synthetic tree generator with a fixed seed, so every run measures the same trees.
+ *
+ * A measurement is repeated until the minimum run time is reached and the fastest run is
+ * reported. Runs predicted to exceed the time limit, from the growth between the two previous
+ * sizes, are reported as skipped instead of being run.
+ *
+ * Usage: bench_suite [--format csv|json] [--min N] [--max N] [--min-time ms] [--limit ms]
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+#include "node.hpp"
+#include "tree.hpp"
+#include "layout.hpp"
+#include "generator.hpp"
+
+using namespace std;
+
+/**
+ * @brief The tree type under test; its fan-out limit admits every shape, including the star.
+ */
+typedef Tree<int, numeric_limits<int>::max()> BenchTree;
+
+/**
+ * @brief The shapes of the benchmarked trees.
+ */
+enum class Shape { Chain, Complete, Random, Star };
+
+/**
+ * @brief Get the name of a shape.
+ *
+ * @param shape The shape.
+ * @return const char* The name.
+ */
+static const char* shape_name(Shape shape) {
+    switch (shape) {
+    case Shape::Chain: return "chain";
+    case Shape::Complete: return "complete";
+    case Shape::Random: return "random";
+    default: return "star";
+    }
+}
+
+/**
+ * @brief Command-line options.
+ */
+struct Options {
+    string format = "csv";        ///< Output format, csv or json.
+    size_t min_nodes = 1000;      ///< Smallest tree size.
+    size_t max_nodes = 10000000;  ///< Largest tree size.
+    double min_time_ms = 100;     ///< Repeat each measurement for at least this long.
+    double limit_ms = 10000;      ///< Skip runs predicted to take longer than this.
+};
+
+/**
+ * @brief A tree of one shape and size, with its keys and parents.
+ */
+struct Fixture {
+    Shape shape;          ///< The shape.
+    vector<int> keys;     ///< Keys in creation order, a random permutation of 0..n-1.
+    vector<long> parents; ///< Parent of each node, always created before the node.
+    BenchTree tree;       ///< The tree, built from the keys and parents.
+    Node<int>* root;      ///< The root of the tree.
+
+    /**
+     * @brief Generate and build a tree.
+     *
+     * @param shape The shape.
+     * @param n The number of nodes.
+     */
+    Fixture(Shape shape, size_t n) : shape(shape) {
+        TreeSpec spec = shape == Shape::Chain ? TreeSpec::chain(n)
+                      : shape == Shape::Complete ? TreeSpec::complete(n, 4)
+                      : shape == Shape::Random ? TreeSpec::random(n) : TreeSpec::star(n);
+        spec.seed = 42;
+        keys = generate_keys<int>(spec);
+        parents = generate_parents(spec, static_cast<size_t>(numeric_limits<int>::max()));
+        root = &tree.build_from_parents(keys, parents);
+    }
+};
+
+/**
+ * @brief A stream buffer that discards its output and counts the bytes.
+ */
+class CountingBuf : public streambuf {
+public:
+    size_t bytes = 0; ///< Bytes written so far.
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) ++bytes;
+        return traits_type::not_eof(c);
+    }
+
+    streamsize xsputn(const char*, streamsize count) override {
+        bytes += static_cast<size_t>(count);
+        return count;
+    }
+};
+
+/**
+ * @brief One run of an operation: its time in milliseconds and the number of items processed.
+ */
+typedef pair<double, size_t> Run;
+
+/**
+ * @brief A benchmarked operation.
+ */
+struct Operation {
+    const char* name;                ///< The name.
+    function<Run(Fixture&)> run;     ///< Runs the operation once and times it.
+};
+
+/**
+ * @brief Return the elapsed time since the given point in milliseconds.
+ *
+ * @param start The starting time point.
+ * @return double The elapsed time in milliseconds.
+ */
+static double elapsed_ms(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+static volatile long long result_sink; ///< Written by do_not_optimize, never read.
+
+/**
+ * @brief Store a result in a volatile sink so the work that produced it is not optimized away.
+ *
+ * @param value The result to keep.
+ */
+static void do_not_optimize(long long value) {
+    result_sink = value;
+}
+
+/**
+ * @brief Time building a fixture's tree node by node through add_sub_node.
+ *
+ * @param fixture The fixture whose keys and parents are used.
+ * @param indexed Whether parents are resolved through the key index or with find_node.
+ * @return Run The build time and the number of nodes added.
+ */
+static Run add_sub_nodes(Fixture& fixture, bool indexed) {
+    size_t n = fixture.keys.size();
+    vector<Node<int> > nodes;
+    nodes.reserve(n);
+    for (size_t i = 0; i < n; ++i) nodes.push_back(Node<int>(fixture.keys[i]));
+    auto start = chrono::steady_clock::now();
+    BenchTree tree;
+    if (indexed) tree.enable_key_index();
+    tree.add_root(nodes[0]);
+    for (size_t i = 1; i < n; ++i) {
+        tree.add_sub_node(nodes[static_cast<size_t>(fixture.parents[i])], nodes[i]);
+    }
+    return Run(elapsed_ms(start), n - 1);
+}
+
+/**
+ * @brief Time a full traversal with one of the tree's iterators, including its construction.
+ *
+ * @param tree The tree.
+ * @param begin The member function returning the begin iterator.
+ * @param end The member function returning the end iterator.
+ * @return Run The traversal time and the number of nodes visited.
+ */
+template <typename Iterator>
+static Run traverse(const BenchTree& tree, Iterator (BenchTree::*begin)() const, Iterator (BenchTree::*end)() const) {
+    auto start = chrono::steady_clock::now();
+    size_t visited = 0;
+    long long sum = 0;
+    for (Iterator it = (tree.*begin)(), last = (tree.*end)(); it != last; ++it) {
+        sum += it->get_key();
+        ++visited;
+    }
+    double ms = elapsed_ms(start);
+    do_not_optimize(sum);
+    return Run(ms, visited);
+}
+
+/**
+ * @brief Get the benchmarked operations.
+ *
+ * @return vector<Operation> The operations in output order.
+ */
+static vector<Operation> operations() {
+    vector<Operation> ops;
+    ops.push_back(Operation{"add_sub_node/index", [](Fixture& f) { return add_sub_nodes(f, true); }});
+    ops.push_back(Operation{"add_sub_node/find_node", [](Fixture& f) { return add_sub_nodes(f, false); }});
+    ops.push_back(Operation{"find_node", [](Fixture& f) {
+        // Look up keys spread over the whole tree, fewer of them on larger trees
+        size_t n = f.keys.size();
+        size_t lookups = max<size_t>(1, min<size_t>(1000, 10000000 / n));
+        vector<Node<int> > targets;
+        for (size_t i = 0; i < lookups; ++i) targets.push_back(Node<int>(f.keys[(i * 7919 + 1) % n]));
+        auto start = chrono::steady_clock::now();
+        size_t found = 0;
+        for (auto& target : targets) found += f.tree.find_node(f.root, target) != nullptr;
+        double ms = elapsed_ms(start);
+        if (found != lookups) cerr << "find_node missed a key" << endl;
+        return Run(ms, lookups);
+    }});
+    ops.push_back(Operation{"bfs", [](Fixture& f) { return traverse(f.tree, &BenchTree::begin_bfs, &BenchTree::end_bfs); }});
+    ops.push_back(Operation{"dfs", [](Fixture& f) { return traverse(f.tree, &BenchTree::begin_dfs, &BenchTree::end_dfs); }});
+    ops.push_back(Operation{"in_order", [](Fixture& f) {
+        return traverse(f.tree, &BenchTree::begin_in_order, &BenchTree::end_in_order);
+    }});
+    ops.push_back(Operation{"post_order", [](Fixture& f) {
+        return traverse(f.tree, &BenchTree::begin_post_order, &BenchTree::end_post_order);
+    }});
+    ops.push_back(Operation{"pre_order", [](Fixture& f) {
+        return traverse(f.tree, &BenchTree::begin_pre_order, &BenchTree::end_pre_order);
+    }});
+    ops.push_back(Operation{"min_heap", [](Fixture& f) {
+        return traverse(f.tree, &BenchTree::begin_min_heap, &BenchTree::end_min_heap);
+    }});
+    ops.push_back(Operation{"operator<<", [](Fixture& f) {
+        CountingBuf buffer;
+        ostream out(&buffer);
+        auto start = chrono::steady_clock::now();
+        out << f.tree;
+        return Run(elapsed_ms(start), f.keys.size());
+    }});
+    ops.push_back(Operation{"layout", [](Fixture& f) {
+        auto start = chrono::steady_clock::now();
+        TreeLayout<Node<int> > layout(100, 100);
+        layout.build(f.root, 0, 0);
+        layout.extent(40);
+        return Run(elapsed_ms(start), f.keys.size());
+    }});
+    return ops;
+}
+
+/**
+ * @brief Run an operation until the minimum time is reached and keep the fastest run.
+ *
+ * @param op The operation.
+ * @param fixture The tree to run it on.
+ * @param min_time_ms The minimum total time.
+ * @return Run The fastest run.
+ */
+static Run best_run(const Operation& op, Fixture& fixture, double min_time_ms) {
+    Run best = op.run(fixture);
+    for (double total = best.first; total < min_time_ms;) {
+        Run run = op.run(fixture);
+        total += run.first;
+        if (run.first < best.first) best = run;
+    }
+    return best;
+}
+
+/**
+ * @brief Writes measurements as CSV lines or JSON objects.
+ */
+class Report {
+public:
+    /**
+     * @brief Start a report.
+     *
+     * @param out The output stream.
+     * @param json Whether to write JSON instead of CSV.
+     */
+    Report(ostream& out, bool json) : out(out), json(json), rows(0) {
+        if (json) {
+            out << "[";
+        } else {
+            out << "operation,shape,nodes,items,ms,ns_per_item,skipped" << endl;
+        }
+    }
+
+    /**
+     * @brief Finish the report.
+     */
+    ~Report() {
+        if (json) out << (rows ? "\n" : "") << "]" << endl;
+    }
+
+    /**
+     * @brief Write one measurement.
+     *
+     * @param op The operation name.
+     * @param shape The shape name.
+     * @param nodes The tree size.
+     * @param run The measured run; ignored when skipped is set.
+     * @param skipped Why the run was skipped, or nullptr if it ran.
+     */
+    void row(const char* op, const char* shape, size_t nodes, const Run& run, const char* skipped) {
+        char ms[32] = "", per_item[32] = "";
+        if (!skipped) {
+            snprintf(ms, sizeof(ms), "%.3f", run.first);
+            snprintf(per_item, sizeof(per_item), "%.2f", run.second ? run.first * 1e6 / run.second : 0.0);
+        }
+        if (json) {
+            out << (rows ? ",\n" : "\n") << "  {\"operation\": \"" << op << "\", \"shape\": \"" << shape
+                << "\", \"nodes\": " << nodes;
+            if (skipped) {
+                out << ", \"skipped\": \"" << skipped << "\"}";
+            } else {
+                out << ", \"items\": " << run.second << ", \"ms\": " << ms << ", \"ns_per_item\": " << per_item << "}";
+            }
+        } else {
+            out << op << "," << shape << "," << nodes << ",";
+            if (skipped) {
+                out << ",,," << skipped << endl;
+            } else {
+                out << run.second << "," << ms << "," << per_item << "," << endl;
+            }
+        }
+        out.flush();
+        ++rows;
+    }
+
+private:
+    ostream& out; ///< The output stream.
+    bool json;    ///< Whether to write JSON.
+    size_t rows;  ///< Measurements written so far.
+};
+
+/**
+ * @brief Parse the command line.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param options Receives the options.
+ * @return true If the command line is valid.
+ * @return false Otherwise.
+ */
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) return false;
+        string flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--format") {
+            options.format = value;
+            if (options.format != "csv" && options.format != "json") return false;
+        } else if (flag == "--min") {
+            options.min_nodes = strtoul(value, nullptr, 10);
+        } else if (flag == "--max") {
+            options.max_nodes = strtoul(value, nullptr, 10);
+        } else if (flag == "--min-time") {
+            options.min_time_ms = strtod(value, nullptr);
+        } else if (flag == "--limit") {
+            options.limit_ms = strtod(value, nullptr);
+        } else {
+            return false;
+        }
+    }
+    return options.min_nodes >= 1;
+}
+
+/**
+ * @brief Main function to run the benchmark suite.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The command-line arguments.
+ * @return int Exit status of the program.
+ */
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " [--format csv|json] [--min N] [--max N] [--min-time ms] [--limit ms]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    vector<Operation> ops = operations();
+    const Shape shapes[] = {Shape::Chain, Shape::Complete, Shape::Random, Shape::Star};
+    // The two most recent (nodes, ms) measurements of each operation and shape
+    map<pair<string, int>, vector<pair<double, double> > > history;
+    Report report(cout, options.format == "json");
+
+    for (size_t n = options.min_nodes; n <= options.max_nodes; n *= 10) {
+        for (Shape shape : shapes) {
+            Fixture fixture(shape, n);
+            for (const Operation& op : ops) {
+                vector<pair<double, double> >& past = history[make_pair(string(op.name), static_cast<int>(shape))];
+                const char* skipped = nullptr;
+                if (!past.empty()) {
+                    // Extrapolate with the growth exponent seen between the last two sizes
+                    double exponent = 1;
+                    if (past.size() == 2 && past[0].second > 0 && past[1].second > 0) {
+                        exponent = log(past[1].second / past[0].second) / log(past[1].first / past[0].first);
+                        exponent = max(1.0, min(3.0, exponent));
+                    }
+                    double predicted = past.back().second * pow(n / past.back().first, exponent);
+                    if (predicted > options.limit_ms) skipped = "time limit";
+                }
+                if (skipped) {
+                    // Larger trees would take longer still
+                    past.assign(1, make_pair(static_cast<double>(n), numeric_limits<double>::infinity()));
+                    report.row(op.name, shape_name(shape), n, Run(0, 0), skipped);
+                    continue;
+                }
+                Run run = best_run(op, fixture, options.min_time_ms);
+                past.push_back(make_pair(static_cast<double>(n), run.first));
+                if (past.size() > 2) past.erase(past.begin());
+                report.row(op.name, shape_name(shape), n, run, nullptr);
+            }
+        }
+    }
+    return 0;
+}
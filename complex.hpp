@@ -15,7 +15,9 @@
 #define COMPLEX_HPP
 
 #include <iostream>
-#include <sstream>
+#include <functional>
+#include <string>
+#include "key_format.hpp"
 
 /**
  * @class Complex
@@ -104,15 +106,37 @@ public:
         return os;
     }
 
+    /**
+     * @brief Stream extraction operator for reading a complex number written by operator<<.
+     * 
+     * Reads the form "a+bi"; on malformed input the stream's failbit is set.
+     * 
+     * @param is The input stream.
+     * @param c The complex number to read into.
+     * @return std::istream& The input stream.
+     */
+    friend std::istream& operator>>(std::istream& is, Complex& c) {
+        double real, imag;
+        char plus, unit;
+        if (is >> real >> plus >> imag >> unit) {
+            if (plus == '+' && unit == 'i') {
+                c = Complex(real, imag);
+            } else {
+                is.setstate(std::ios::failbit);
+            }
+        }
+        return is;
+    }
+
     /**
      * @brief Convert the complex number to a string representation.
      * 
      * @return std::string The string representation of the complex number.
      */
     std::string toString() const {
-        std::ostringstream oss;
-        oss << real << "+" << imag << "i";
-        return oss.str();
+        std::string text;
+        append_key(text, *this);
+        return text;
     }
 
 private:
@@ -120,4 +144,36 @@ private:
     double imag; ///< The imaginary part of the complex number.
 };
 
+/**
+ * @brief Write a complex number as "real+imagi" into a character range without allocating.
+ * 
+ * @param first The start of the range.
+ * @param last The end of the range.
+ * @param c The complex number.
+ * @return char* The end of the written text, or nullptr if it does not fit.
+ * @see format_key
+ */
+inline char* format_key(char* first, char* last, const Complex& c) {
+    char* p = key_format_detail::write_floating(first, last, c.get_real());
+    if (!p || p == last) return nullptr;
+    *p++ = '+';
+    p = key_format_detail::write_floating(p, last, c.get_imag());
+    if (!p || p == last) return nullptr;
+    *p++ = 'i';
+    return p;
+}
+
+namespace std {
+/**
+ * @brief Hash specialization so Complex keys can be used in hashed containers.
+ */
+template <>
+struct hash<Complex> {
+    size_t operator()(const Complex& c) const {
+        size_t h = hash<double>()(c.get_real());
+        return h ^ (hash<double>()(c.get_imag()) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    }
+};
+} // namespace std
+
 #endif // COMPLEX_HPP
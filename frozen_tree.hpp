@@ -0,0 +1,383 @@
+/**
+ * @file frozen_tree.hpp
+ * @brief Declaration of the FrozenTree class, an immutable breadth-first flat tree snapshot,
+ * and of FlatTreeView, a non-owning view of the same arrays.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the declaration of the FrozenTree class, which stores a tree as two flat
+ * arrays: the keys in breadth-first order and, for each node, the offset of its first child.
+ * Because the children of every node are contiguous in breadth-first order, node i has the
+ * children first_child(i) up to first_child(i + 1) - 1. All traversal orders supported by
+ * Tree run over these arrays with sequential memory access and no pointer chasing, and the
+ * keys can be copied into ColumnarKeys for vectorized searches and reductions. The traversals
+ * are implemented by FlatTreeView, which reads the arrays through plain pointers and so also
+ * serves trees stored in memory-mapped files.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef FROZEN_TREE_HPP
+#define FROZEN_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "columnar_keys.hpp"
+
+/**
+ * @brief The traversal orders offered by the tree types.
+ */
+enum class Traversal {
+    BFS,       ///< Breadth-first order.
+    DFS,       ///< Depth-first order, the same as pre-order.
+    InOrder,   ///< First child, node, second child.
+    PostOrder, ///< Children before their parent.
+    PreOrder,  ///< Parent before its children.
+    MinHeap    ///< Ascending key order; the order among equal keys is unspecified.
+};
+
+/**
+ * @class FlatTreeView
+ * @brief A non-owning view of breadth-first flat tree arrays.
+ *
+ * The view holds plain pointers, so it works the same over a FrozenTree's vectors and over
+ * arrays that live in a memory-mapped file. Every traversal order runs directly on the arrays.
+ *
+ * @tparam T The type of the key stored in the nodes.
+ */
+template <typename T>
+class FlatTreeView {
+public:
+    typedef std::uint32_t index_type; ///< Type of node indices and child offsets.
+
+    /**
+     * @brief Construct an empty view.
+     */
+    FlatTreeView() : arity(0), count(0), key_data(nullptr), offset_data(nullptr) {}
+
+    /**
+     * @brief Construct a view over breadth-first arrays.
+     *
+     * @param max_children The fan-out limit of the tree the arrays were taken from.
+     * @param count The number of nodes.
+     * @param keys The keys in breadth-first order.
+     * @param first_child The count + 1 first-child offsets.
+     */
+    FlatTreeView(int max_children, std::size_t count, const T* keys, const index_type* first_child)
+        : arity(max_children), count(count), key_data(keys), offset_data(first_child) {}
+
+    /**
+     * @brief Get the number of nodes.
+     *
+     * @return std::size_t The number of nodes.
+     */
+    std::size_t size() const { return count; }
+
+    /**
+     * @brief Check whether the view has no nodes.
+     *
+     * @return true If the view is empty.
+     * @return false Otherwise.
+     */
+    bool empty() const { return count == 0; }
+
+    /**
+     * @brief Get the fan-out limit of the tree the arrays were taken from.
+     *
+     * @return int The maximum number of children per node.
+     */
+    int max_children() const { return arity; }
+
+    /**
+     * @brief Get the key of a node.
+     *
+     * @param i The node index; the root is node 0.
+     * @return const T& The key of the node.
+     */
+    const T& key(std::size_t i) const { return key_data[i]; }
+
+    /**
+     * @brief Get the index of a node's first child.
+     *
+     * @param i The node index.
+     * @return std::size_t The index of the first child, meaningful only if the node has children.
+     */
+    std::size_t first_child(std::size_t i) const { return offset_data[i]; }
+
+    /**
+     * @brief Get the number of children of a node.
+     *
+     * @param i The node index.
+     * @return std::size_t The number of children.
+     */
+    std::size_t child_count(std::size_t i) const { return offset_data[i + 1] - offset_data[i]; }
+
+    /**
+     * @brief Get the key array.
+     *
+     * @return const T* The keys in breadth-first order.
+     */
+    const T* keys() const { return key_data; }
+
+    /**
+     * @brief Get the offset array.
+     *
+     * @return const index_type* The size() + 1 first-child offsets.
+     */
+    const index_type* child_offsets() const { return offset_data; }
+
+    /**
+     * @brief Call a function on every key in the given traversal order.
+     *
+     * Keys come in the same order as from the matching Tree iterator, except that in
+     * Traversal::MinHeap order keys that compare equal may come out in a different order.
+     *
+     * @param order The traversal order.
+     * @param fn The function, called as fn(key).
+     */
+    template <typename F>
+    void for_each(Traversal order, F fn) const {
+        if (empty()) return;
+        switch (order) {
+        case Traversal::BFS:
+            for (std::size_t i = 0; i < count; ++i) fn(key_data[i]);
+            break;
+        case Traversal::DFS:
+        case Traversal::PreOrder:
+            visit_pre_order(fn);
+            break;
+        case Traversal::InOrder:
+            visit_in_order(fn);
+            break;
+        case Traversal::PostOrder:
+            visit_post_order(fn);
+            break;
+        case Traversal::MinHeap:
+            visit_min_heap(fn);
+            break;
+        }
+    }
+
+private:
+    int arity;                     ///< Fan-out limit of the source tree.
+    std::size_t count;             ///< Number of nodes.
+    const T* key_data;             ///< Keys in breadth-first order.
+    const index_type* offset_data; ///< First-child offsets plus a final entry.
+
+    /**
+     * @brief Visit keys in pre-order.
+     *
+     * @param fn The function called on each key.
+     */
+    template <typename F>
+    void visit_pre_order(F& fn) const {
+        std::vector<index_type> stack(1, 0);
+        while (!stack.empty()) {
+            index_type node = stack.back();
+            stack.pop_back();
+            fn(key_data[node]);
+            for (index_type child = offset_data[node + 1]; child > offset_data[node]; --child) {
+                stack.push_back(child - 1);
+            }
+        }
+    }
+
+    /**
+     * @brief Visit keys in in-order, matching Tree::InOrderIterator.
+     *
+     * @param fn The function called on each key.
+     */
+    template <typename F>
+    void visit_in_order(F& fn) const {
+        std::vector<index_type> stack;
+        push_left(stack, 0);
+        while (!stack.empty()) {
+            index_type node = stack.back();
+            stack.pop_back();
+            fn(key_data[node]);
+            if (child_count(node) > 1) push_left(stack, offset_data[node] + 1);
+        }
+    }
+
+    /**
+     * @brief Push a node and its chain of first children.
+     *
+     * @param stack The stack to push onto.
+     * @param node The starting node.
+     */
+    void push_left(std::vector<index_type>& stack, index_type node) const {
+        while (true) {
+            stack.push_back(node);
+            if (child_count(node) == 0) return;
+            node = offset_data[node];
+        }
+    }
+
+    /**
+     * @brief Visit keys in post-order.
+     *
+     * @param fn The function called on each key.
+     */
+    template <typename F>
+    void visit_post_order(F& fn) const {
+        std::vector<std::pair<index_type, index_type> > stack; // (node, next child)
+        stack.push_back(std::make_pair(0, offset_data[0]));
+        while (!stack.empty()) {
+            std::pair<index_type, index_type>& top = stack.back();
+            if (top.second < offset_data[top.first + 1]) {
+                index_type child = top.second++;
+                stack.push_back(std::make_pair(child, offset_data[child]));
+            } else {
+                fn(key_data[top.first]);
+                stack.pop_back();
+            }
+        }
+    }
+
+    /**
+     * @brief Visit keys in ascending order; equal keys keep breadth-first order.
+     *
+     * Tree::MinHeapIterator pops from a binary heap instead, so keys that compare equal but
+     * are otherwise distinguishable may come out in a different order there.
+     *
+     * @param fn The function called on each key.
+     */
+    template <typename F>
+    void visit_min_heap(F& fn) const {
+        std::vector<index_type> order(count);
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<index_type>(i);
+        const T* keys = key_data;
+        std::stable_sort(order.begin(), order.end(), [&keys](index_type a, index_type b) {
+            return keys[a] < keys[b];
+        });
+        for (index_type i : order) fn(key_data[i]);
+    }
+};
+
+/**
+ * @class FrozenTree
+ * @brief An immutable tree snapshot stored as breadth-first flat arrays.
+ *
+ * @tparam T The type of the key stored in the nodes.
+ */
+template <typename T>
+class FrozenTree {
+public:
+    typedef typename FlatTreeView<T>::index_type index_type; ///< Type of node indices and child offsets.
+
+    /**
+     * @brief Construct an empty snapshot.
+     */
+    FrozenTree() : arity(0), offsets(1, 0) {}
+
+    /**
+     * @brief Construct a snapshot from breadth-first arrays.
+     *
+     * @param max_children The fan-out limit of the tree the snapshot was taken from.
+     * @param keys The keys in breadth-first order.
+     * @param first_child The first-child offsets, one per node plus a final entry equal to the
+     * number of nodes.
+     */
+    FrozenTree(int max_children, std::vector<T> keys, std::vector<index_type> first_child)
+        : arity(max_children), key_array(std::move(keys)), offsets(std::move(first_child)) {}
+
+    /**
+     * @brief Get the number of nodes.
+     *
+     * @return std::size_t The number of nodes.
+     */
+    std::size_t size() const { return key_array.size(); }
+
+    /**
+     * @brief Check whether the snapshot has no nodes.
+     *
+     * @return true If the snapshot is empty.
+     * @return false Otherwise.
+     */
+    bool empty() const { return key_array.empty(); }
+
+    /**
+     * @brief Get the fan-out limit of the tree the snapshot was taken from.
+     *
+     * @return int The maximum number of children per node.
+     */
+    int max_children() const { return arity; }
+
+    /**
+     * @brief Get the key of a node.
+     *
+     * @param i The node index; the root is node 0.
+     * @return const T& The key of the node.
+     */
+    const T& key(std::size_t i) const { return key_array[i]; }
+
+    /**
+     * @brief Get the index of a node's first child.
+     *
+     * @param i The node index.
+     * @return std::size_t The index of the first child, meaningful only if the node has children.
+     */
+    std::size_t first_child(std::size_t i) const { return offsets[i]; }
+
+    /**
+     * @brief Get the number of children of a node.
+     *
+     * @param i The node index.
+     * @return std::size_t The number of children.
+     */
+    std::size_t child_count(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+    /**
+     * @brief Get all keys in breadth-first order.
+     *
+     * @return const std::vector<T>& The keys.
+     */
+    const std::vector<T>& keys() const { return key_array; }
+
+    /**
+     * @brief Get all first-child offsets, including the final entry.
+     *
+     * @return const std::vector<index_type>& The offsets.
+     */
+    const std::vector<index_type>& child_offsets() const { return offsets; }
+
+    /**
+     * @brief Copy the keys into columns for vectorized searches and reductions.
+     *
+     * @return ColumnarKeys<T> The key columns, indexed like the snapshot.
+     */
+    ColumnarKeys<T> columns() const { return ColumnarKeys<T>(key_array); }
+
+    /**
+     * @brief Get a non-owning view of the snapshot's arrays.
+     *
+     * @return FlatTreeView<T> The view, valid while the snapshot is alive and unchanged.
+     */
+    FlatTreeView<T> view() const {
+        return FlatTreeView<T>(arity, key_array.size(), key_array.data(), offsets.data());
+    }
+
+    /**
+     * @brief Call a function on every key in the given traversal order.
+     *
+     * Keys come in the same order as from the matching Tree iterator, except that in
+     * Traversal::MinHeap order keys that compare equal may come out in a different order.
+     *
+     * @param order The traversal order.
+     * @param fn The function, called as fn(key).
+     */
+    template <typename F>
+    void for_each(Traversal order, F fn) const {
+        view().for_each(order, fn);
+    }
+
+private:
+    int arity;                      ///< Fan-out limit of the source tree.
+    std::vector<T> key_array;       ///< Keys in breadth-first order.
+    std::vector<index_type> offsets; ///< First-child offsets plus a final entry.
+};
+
+#endif // FROZEN_TREE_HPP
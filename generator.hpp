@@ -0,0 +1,262 @@
+/**
+ * @file generator.hpp
+ * @brief Declaration of the TreeSpec workload description and the synthetic tree generator.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains a generator of synthetic trees for tests and benchmarks. A TreeSpec
+ * describes the node count, the distribution of child counts, an optional depth limit, the key
+ * order and the share of duplicate keys, plus a seed; the same spec always produces the same
+ * tree. The generator first draws a parent array and a key array, then builds the tree with
+ * Tree::build_from_parents, so trees of millions of nodes, including million-deep chains, are
+ * generated without recursion or key lookups.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "tree.hpp"
+
+/**
+ * @brief How the number of children of each node is chosen.
+ */
+enum class Branching {
+    Fixed,     ///< Every node gets max_children children: a chain for 1, complete trees otherwise.
+    Uniform,   ///< Uniform between min_children and max_children.
+    Geometric, ///< Geometric with mean mean_children, giving a few wide nodes and many leaves.
+    Attach     ///< Each new node picks a uniformly random earlier node with room, a random recursive tree.
+};
+
+/**
+ * @brief The order in which keys are given to the nodes, which are created breadth first.
+ */
+enum class KeyOrder {
+    Ascending,  ///< 0, 1, 2, ... in creation order.
+    Descending, ///< n-1, n-2, ... in creation order.
+    Shuffled,   ///< A random permutation of 0..n-1.
+    Random      ///< Independent uniform values in 0..4n-1.
+};
+
+/**
+ * @struct TreeSpec
+ * @brief A description of a synthetic tree.
+ *
+ * Child counts are drawn breadth first and capped by k, by max_depth and by the nodes still
+ * to be placed. If every open node has been given its children before n nodes exist, the
+ * remaining nodes are added one at a time to the shallowest node that still has room.
+ */
+struct TreeSpec {
+    std::size_t nodes;          ///< Number of nodes, at least 1.
+    Branching branching;        ///< Distribution of child counts.
+    std::size_t min_children;   ///< Smallest child count for Uniform.
+    std::size_t max_children;   ///< Child count for Fixed and largest child count for Uniform.
+    double mean_children;       ///< Mean child count for Geometric.
+    std::size_t max_depth;      ///< Depth below which no children are added; the root has depth 0.
+    KeyOrder keys;              ///< Key order.
+    double duplicate_rate;      ///< Probability that a key repeats an earlier node's key.
+    std::uint64_t seed;         ///< Seed of the random number generator.
+
+    /**
+     * @brief Describe a tree with uniformly 0 to 2 children per node and shuffled unique keys.
+     *
+     * @param node_count The number of nodes.
+     * @param random_seed The seed.
+     */
+    explicit TreeSpec(std::size_t node_count, std::uint64_t random_seed = 1)
+        : nodes(node_count), branching(Branching::Uniform), min_children(0), max_children(2),
+          mean_children(1), max_depth(std::numeric_limits<std::size_t>::max()), keys(KeyOrder::Shuffled),
+          duplicate_rate(0), seed(random_seed) {}
+
+    /**
+     * @brief Describe a chain, each node the only child of the one before.
+     *
+     * @param node_count The number of nodes.
+     * @return TreeSpec The spec.
+     */
+    static TreeSpec chain(std::size_t node_count) { return complete(node_count, 1); }
+
+    /**
+     * @brief Describe a complete tree, filled level by level.
+     *
+     * @param node_count The number of nodes.
+     * @param arity The number of children of every inner node but the last.
+     * @return TreeSpec The spec.
+     */
+    static TreeSpec complete(std::size_t node_count, std::size_t arity) {
+        TreeSpec spec(node_count);
+        spec.branching = Branching::Fixed;
+        spec.max_children = arity;
+        return spec;
+    }
+
+    /**
+     * @brief Describe a star, every other node a child of the root.
+     *
+     * @param node_count The number of nodes.
+     * @return TreeSpec The spec.
+     */
+    static TreeSpec star(std::size_t node_count) {
+        return complete(node_count, node_count > 1 ? node_count - 1 : 1);
+    }
+
+    /**
+     * @brief Describe a random recursive tree.
+     *
+     * @param node_count The number of nodes.
+     * @param random_seed The seed.
+     * @return TreeSpec The spec.
+     */
+    static TreeSpec random(std::size_t node_count, std::uint64_t random_seed = 1) {
+        TreeSpec spec(node_count, random_seed);
+        spec.branching = Branching::Attach;
+        return spec;
+    }
+};
+
+/**
+ * @brief Convert a generated number to a key.
+ *
+ * @tparam T The key type, constructible from an integer.
+ * @param value The number.
+ * @return T The key.
+ */
+template <typename T>
+T generated_key(std::uint64_t value) {
+    return static_cast<T>(value);
+}
+
+/**
+ * @brief Convert a generated number to a string key.
+ */
+template <>
+inline std::string generated_key<std::string>(std::uint64_t value) {
+    return std::to_string(value);
+}
+
+/**
+ * @brief Draw the parent of every node of a synthetic tree.
+ *
+ * @param spec The tree description.
+ * @param k The largest number of children per node.
+ * @return std::vector<long> The parent index of every node, -1 for the root at index 0;
+ * every parent has a smaller index than its children.
+ * @throws std::invalid_argument If the spec has no nodes, or k and max_depth cannot hold
+ * spec.nodes nodes.
+ */
+inline std::vector<long> generate_parents(const TreeSpec& spec, std::size_t k) {
+    if (spec.nodes == 0) throw std::invalid_argument("generator: a tree needs at least one node");
+    std::mt19937_64 rng(spec.seed);
+    std::vector<long> parents(1, -1);
+    std::vector<std::size_t> depth(1, 0);
+    std::vector<std::size_t> children(1, 0);
+    parents.reserve(spec.nodes);
+    depth.reserve(spec.nodes);
+    children.reserve(spec.nodes);
+    auto has_room = [&](std::size_t node) { return children[node] < k && depth[node] < spec.max_depth; };
+    auto add_child = [&](std::size_t parent) {
+        parents.push_back(static_cast<long>(parent));
+        depth.push_back(depth[parent] + 1);
+        children.push_back(0);
+        ++children[parent];
+    };
+
+    if (spec.branching == Branching::Attach) {
+        // Nodes with room, removed lazily once they fill up
+        std::vector<std::size_t> open(1, 0);
+        while (parents.size() < spec.nodes) {
+            if (open.empty()) throw std::invalid_argument("generator: k and max_depth cannot hold the nodes");
+            std::size_t pick = std::uniform_int_distribution<std::size_t>(0, open.size() - 1)(rng);
+            std::size_t parent = open[pick];
+            if (!has_room(parent)) {
+                open[pick] = open.back();
+                open.pop_back();
+                continue;
+            }
+            add_child(parent);
+            if (has_room(parents.size() - 1)) open.push_back(parents.size() - 1);
+        }
+        return parents;
+    }
+
+    std::uniform_int_distribution<std::size_t> uniform(spec.min_children, std::max(spec.min_children, spec.max_children));
+    std::geometric_distribution<std::size_t> geometric(1 / (1 + std::max(spec.mean_children, 0.0)));
+    std::size_t head = 0;  // Next node to draw a child count for
+    std::size_t spare = 0; // Shallowest node that may still have room
+    while (parents.size() < spec.nodes) {
+        if (head < parents.size()) {
+            std::size_t node = head++;
+            if (depth[node] >= spec.max_depth) continue;
+            std::size_t count = spec.branching == Branching::Fixed ? spec.max_children
+                              : spec.branching == Branching::Uniform ? uniform(rng) : geometric(rng);
+            count = std::min(std::min(count, k), spec.nodes - parents.size());
+            for (std::size_t i = 0; i < count; ++i) add_child(node);
+        } else {
+            while (spare < parents.size() && !has_room(spare)) ++spare;
+            if (spare == parents.size()) throw std::invalid_argument("generator: k and max_depth cannot hold the nodes");
+            add_child(spare);
+        }
+    }
+    return parents;
+}
+
+/**
+ * @brief Draw the key of every node of a synthetic tree.
+ *
+ * @tparam T The key type.
+ * @param spec The tree description.
+ * @return std::vector<T> The key of every node in creation order.
+ */
+template <typename T>
+std::vector<T> generate_keys(const TreeSpec& spec) {
+    // A separate stream, so the keys do not depend on how many numbers the shape used
+    std::mt19937_64 rng(spec.seed ^ 0x9e3779b97f4a7c15ULL);
+    std::size_t n = spec.nodes;
+    std::vector<std::uint64_t> values(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        values[i] = spec.keys == KeyOrder::Descending ? n - 1 - i : i;
+    }
+    if (spec.keys == KeyOrder::Shuffled) {
+        std::shuffle(values.begin(), values.end(), rng);
+    } else if (spec.keys == KeyOrder::Random) {
+        std::uniform_int_distribution<std::uint64_t> any(0, 4 * static_cast<std::uint64_t>(n) - 1);
+        for (auto& value : values) value = any(rng);
+    }
+    if (spec.duplicate_rate > 0) {
+        std::bernoulli_distribution repeat(std::min(spec.duplicate_rate, 1.0));
+        for (std::size_t i = 1; i < n; ++i) {
+            if (repeat(rng)) values[i] = values[std::uniform_int_distribution<std::size_t>(0, i - 1)(rng)];
+        }
+    }
+    std::vector<T> keys;
+    keys.reserve(n);
+    for (auto value : values) keys.push_back(generated_key<T>(value));
+    return keys;
+}
+
+/**
+ * @brief Generate a synthetic tree.
+ *
+ * The nodes are created in the tree's arena and replace its current root.
+ *
+ * @param tree The tree to fill; its key type must be constructible from an integer or have a
+ * generated_key specialization.
+ * @param spec The tree description.
+ * @return NodeType& The root.
+ * @throws std::invalid_argument If the spec cannot be satisfied with the tree's k.
+ */
+template <typename T, int k, typename NodeType>
+NodeType& generate_tree(Tree<T, k, NodeType>& tree, const TreeSpec& spec) {
+    return tree.build_from_parents(generate_keys<T>(spec), generate_parents(spec, static_cast<std::size_t>(k)));
+}
+
+#endif // GENERATOR_HPP
@@ -0,0 +1,217 @@
+/**
+ * @file key_format.hpp
+ * @brief Declaration of the format_key and append_key functions for allocation-free key text.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains functions that write the text form of a key into a caller-provided
+ * character range, in the spirit of std::to_chars. Integers are converted by hand, floating
+ * point values with snprintf("%g") and strings by copying; the text is the same as operator<<
+ * produces on a stream with default flags. Key types can add their own format_key overload,
+ * found by argument-dependent lookup, as complex.hpp does for Complex. Any other type falls
+ * back to its operator<<, writing through a per-thread stream bound to the caller's range, so
+ * no key is formatted through a freshly allocated stringstream.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef KEY_FORMAT_HPP
+#define KEY_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+
+namespace key_format_detail {
+
+/**
+ * @brief Whether an integral type is printed by streams as a character rather than a number.
+ */
+template <typename T>
+struct is_character : std::integral_constant<bool,
+    std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+    std::is_same<T, unsigned char>::value || std::is_same<T, wchar_t>::value ||
+    std::is_same<T, char16_t>::value || std::is_same<T, char32_t>::value> {};
+
+/**
+ * @brief Whether a key type has a hand-written conversion.
+ */
+template <typename T>
+struct is_number : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && !is_character<T>::value> {};
+
+/**
+ * @brief A stream buffer that writes into a fixed character range and fails when it is full.
+ */
+class RangeBuf : public std::streambuf {
+public:
+    /**
+     * @brief Point the buffer at a new range.
+     *
+     * @param first The start of the range.
+     * @param last The end of the range.
+     */
+    void reset(char* first, char* last) {
+        setp(first, last);
+        full = false;
+    }
+
+    /**
+     * @brief Get the end of the text written so far.
+     *
+     * @return char* The end of the text, or nullptr if it did not fit.
+     */
+    char* end() const { return full ? nullptr : pptr(); }
+
+protected:
+    int_type overflow(int_type) override {
+        full = true;
+        return traits_type::eof();
+    }
+
+private:
+    bool full = false; ///< Set once a write did not fit.
+};
+
+/**
+ * @brief Write the digits of an unsigned value.
+ *
+ * @param first The start of the range.
+ * @param last The end of the range.
+ * @param value The value.
+ * @return char* The end of the digits, or nullptr if they do not fit.
+ */
+inline char* write_unsigned(char* first, char* last, unsigned long long value) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    std::size_t count = static_cast<std::size_t>(digits + sizeof(digits) - p);
+    if (static_cast<std::size_t>(last - first) < count) return nullptr;
+    std::memcpy(first, p, count);
+    return first + count;
+}
+
+/**
+ * @brief Write a floating-point value like a default-formatted stream does.
+ *
+ * @param first The start of the range.
+ * @param last The end of the range.
+ * @param value The value.
+ * @return char* The end of the text, or nullptr if it does not fit.
+ */
+inline char* write_floating(char* first, char* last, double value) {
+    char text[32];
+    int count = std::snprintf(text, sizeof(text), "%g", value);
+    if (count < 0 || static_cast<std::size_t>(last - first) < static_cast<std::size_t>(count)) return nullptr;
+    std::memcpy(first, text, static_cast<std::size_t>(count));
+    return first + count;
+}
+
+/**
+ * @brief Write a signed integer.
+ */
+template <typename T>
+char* write_number(char* first, char* last, T value, std::true_type /* integral */, std::true_type /* signed */) {
+    if (value >= 0) return write_unsigned(first, last, static_cast<unsigned long long>(value));
+    if (first == last) return nullptr;
+    *first = '-';
+    return write_unsigned(first + 1, last, 0ULL - static_cast<unsigned long long>(value));
+}
+
+/**
+ * @brief Write an unsigned integer or a bool.
+ */
+template <typename T>
+char* write_number(char* first, char* last, T value, std::true_type /* integral */, std::false_type /* signed */) {
+    return write_unsigned(first, last, static_cast<unsigned long long>(value));
+}
+
+/**
+ * @brief Write a floating-point value.
+ */
+template <typename T, typename Signed>
+char* write_number(char* first, char* last, T value, std::false_type /* integral */, Signed) {
+    return write_floating(first, last, static_cast<double>(value));
+}
+
+/**
+ * @brief Write a number with the hand-written conversions.
+ */
+template <typename T>
+char* format(char* first, char* last, const T& key, std::true_type /* number */) {
+    return write_number(first, last, key, std::is_integral<T>(), std::is_signed<T>());
+}
+
+/**
+ * @brief Write any other key through its operator<<.
+ */
+template <typename T>
+char* format(char* first, char* last, const T& key, std::false_type /* number */) {
+    static thread_local RangeBuf buffer;
+    static thread_local std::ostream stream(&buffer);
+    buffer.reset(first, last);
+    stream.clear();
+    stream.flags(std::ios_base::dec | std::ios_base::skipws);
+    stream.precision(6);
+    stream << key;
+    return buffer.end();
+}
+
+} // namespace key_format_detail
+
+/**
+ * @brief Write the text form of a key into a character range.
+ *
+ * @param first The start of the range.
+ * @param last The end of the range.
+ * @param key The key.
+ * @return char* The end of the written text, or nullptr if it does not fit; the range
+ * contents are unspecified in that case.
+ */
+template <typename T>
+char* format_key(char* first, char* last, const T& key) {
+    return key_format_detail::format(first, last, key, key_format_detail::is_number<T>());
+}
+
+/**
+ * @brief Write a string key.
+ */
+inline char* format_key(char* first, char* last, const std::string& key) {
+    if (static_cast<std::size_t>(last - first) < key.size()) return nullptr;
+    std::memcpy(first, key.data(), key.size());
+    return first + key.size();
+}
+
+/**
+ * @brief Append the text form of a key to a string.
+ *
+ * The text is written straight into the string's storage, so a string whose capacity is
+ * reused across calls does not allocate.
+ *
+ * @param out The string to append to.
+ * @param key The key.
+ */
+template <typename T>
+void append_key(std::string& out, const T& key) {
+    std::size_t old_size = out.size();
+    std::size_t room = 32;
+    while (true) {
+        out.resize(old_size + room);
+        char* first = &out[0] + old_size;
+        char* end = format_key(first, first + room, key);
+        if (end) {
+            out.resize(old_size + static_cast<std::size_t>(end - first));
+            return;
+        }
+        room *= 2;
+    }
+}
+
+#endif // KEY_FORMAT_HPP
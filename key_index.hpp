@@ -0,0 +1,102 @@
+/**
+ * @file key_index.hpp
+ * @brief Declaration of the KeyIndex class for O(1) expected key-to-node lookup.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the declaration of the KeyIndex class, an optional hash index that a Tree
+ * can maintain alongside its nodes so that parent resolution in add_sub_node does not need a
+ * full depth-first search. Trees of key types without a std::hash specialization cannot enable
+ * the index and keep resolving parents with find_node.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef KEY_INDEX_HPP
+#define KEY_INDEX_HPP
+
+#include <unordered_map>
+#include <functional>
+#include <type_traits>
+
+/**
+ * @brief Trait telling whether std::hash is usable for the key type.
+ *
+ * @tparam T The key type.
+ */
+template <typename T>
+struct is_hashable_key : std::is_default_constructible<std::hash<T> > {};
+
+/**
+ * @class KeyIndex
+ * @brief A hash map from keys to the first node added with that key.
+ *
+ * @tparam T The type of the key stored in the nodes.
+ * @tparam NodeType The node type of the indexed tree.
+ * @tparam Hashable Whether std::hash<T> is available.
+ */
+template <typename T, typename NodeType, bool Hashable = is_hashable_key<T>::value>
+class KeyIndex {
+public:
+    /**
+     * @brief Look up the node registered for a key.
+     *
+     * @param key The key to look up.
+     * @return NodeType* Pointer to the node or nullptr if the key is not indexed.
+     */
+    NodeType* lookup(const T& key) const {
+        auto it = map.find(key);
+        return it == map.end() ? nullptr : it->second;
+    }
+
+    /**
+     * @brief Register a node under its key.
+     *
+     * The first node registered for a key wins, so duplicate keys resolve to the node that was
+     * added first.
+     *
+     * @param node The node to register.
+     */
+    void insert(NodeType* node) {
+        map.insert(std::make_pair(node->get_key(), node));
+    }
+
+    /**
+     * @brief Reserve room for a number of keys.
+     *
+     * @param count The expected number of keys.
+     */
+    void reserve(std::size_t count) { map.reserve(count); }
+
+    /**
+     * @brief Remove all keys from the index.
+     */
+    void clear() { map.clear(); }
+
+    /**
+     * @brief Get the number of indexed keys.
+     *
+     * @return std::size_t The number of distinct keys.
+     */
+    std::size_t size() const { return map.size(); }
+
+private:
+    std::unordered_map<T, NodeType*> map; ///< Key to node map.
+};
+
+/**
+ * @brief KeyIndex stand-in for key types that cannot be hashed.
+ *
+ * Only lets trees of such types compile: enable_key_index never creates one for them.
+ */
+template <typename T, typename NodeType>
+class KeyIndex<T, NodeType, false> {
+public:
+    NodeType* lookup(const T&) const { return nullptr; }
+    void insert(NodeType*) {}
+    void reserve(std::size_t) {}
+    void clear() {}
+    std::size_t size() const { return 0; }
+};
+
+#endif // KEY_INDEX_HPP
@@ -0,0 +1,377 @@
+/**
+ * @file layout.hpp
+ * @brief Declaration of the TreeLayout class, a cached node-position layout for drawing trees.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the declaration of the TreeLayout class, which places every node of a tree on
+ * a grid the way the SFML demo does: a leaf is one slot wide, an inner node is as wide as its
+ * children together, and children sit one row below their parent. The children's slots together
+ * span the parent's slots, centred under the parent, and each child is placed over the leftmost
+ * slot of its own span rather than at the span's centre. Widths and positions are computed once
+ * with iterative walks and kept until the tree changes; attaching a subtree updates the widths
+ * along the path to the root only, and positions are recomputed in one linear pass the next time
+ * they are read. The same pass gathers each subtree's bounding box, so the tree itself serves as a
+ * bounding-volume hierarchy for viewport queries: subtrees outside the view are skipped whole, and
+ * subtrees too small to see can be reported as one aggregate instead of node by node. The layout
+ * has no SFML dependency.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class TreeLayout
+ * @brief Cached subtree widths and node positions for drawing a tree.
+ *
+ * @tparam NodeType The node type of the tree.
+ */
+template <typename NodeType>
+class TreeLayout {
+public:
+    /**
+     * @brief A position in drawing coordinates.
+     */
+    struct Point {
+        float x; ///< Horizontal coordinate.
+        float y; ///< Vertical coordinate.
+    };
+
+    /**
+     * @brief An axis-aligned rectangle in drawing coordinates.
+     */
+    struct Box {
+        float left;   ///< Smallest horizontal coordinate.
+        float top;    ///< Smallest vertical coordinate.
+        float right;  ///< Largest horizontal coordinate.
+        float bottom; ///< Largest vertical coordinate.
+    };
+
+    /**
+     * @brief Construct an empty layout.
+     *
+     * @param horizontal_spacing The width of one slot.
+     * @param vertical_spacing The distance between rows.
+     */
+    TreeLayout(float horizontal_spacing, float vertical_spacing)
+        : horizontal(horizontal_spacing), vertical(vertical_spacing), origin_x(0), origin_y(0),
+          root(nullptr), dirty(false), revision(0) {}
+
+    /**
+     * @brief Lay out a whole tree.
+     *
+     * @param tree_root The root of the tree, or nullptr for an empty layout.
+     * @param x The horizontal position of the root.
+     * @param y The vertical position of the root.
+     */
+    void build(NodeType* tree_root, float x, float y) {
+        entries.clear();
+        slots.clear();
+        root = tree_root;
+        origin_x = x;
+        origin_y = y;
+        if (root) add_subtree(root, NONE);
+        dirty = true;
+        ++revision;
+    }
+
+    /**
+     * @brief Account for a subtree that has just been attached to a laid-out node.
+     *
+     * Call after parent.add_child(&child), or after Tree::add_sub_node returned the parent.
+     * The widths of the parent and its ancestors change by the width the subtree adds, so
+     * only the path to the root is visited; positions are refreshed on the next read.
+     *
+     * @param parent The node the subtree was attached to.
+     * @param child The root of the attached subtree.
+     * @throws std::invalid_argument If the parent is not part of the layout.
+     */
+    void attach(NodeType& parent, NodeType& child) {
+        auto found = slots.find(&parent);
+        if (found == slots.end()) throw std::invalid_argument("layout: parent is not laid out");
+        std::size_t p = found->second;
+        bool was_leaf = entries[p].width == 1 && parent.children.size() == 1;
+        std::size_t c = add_subtree(&child, p);
+        int added = entries[c].width - (was_leaf ? 1 : 0);
+        for (std::size_t i = p; added != 0 && i != NONE; i = entries[i].parent) {
+            entries[i].width += added;
+        }
+        dirty = true;
+        ++revision;
+    }
+
+    /**
+     * @brief Move the root, and with it the whole tree.
+     *
+     * @param x The horizontal position of the root.
+     * @param y The vertical position of the root.
+     */
+    void set_origin(float x, float y) {
+        origin_x = x;
+        origin_y = y;
+        dirty = true;
+        ++revision;
+    }
+
+    /**
+     * @brief Get the number of laid-out nodes.
+     *
+     * @return std::size_t The number of nodes.
+     */
+    std::size_t size() const { return entries.size(); }
+
+    /**
+     * @brief Check whether a node is part of the layout.
+     *
+     * @param node The node.
+     * @return true If the node has been laid out.
+     * @return false Otherwise.
+     */
+    bool contains(const NodeType& node) const { return slots.count(&node) != 0; }
+
+    /**
+     * @brief Get the width of a node's subtree in slots.
+     *
+     * @param node A laid-out node.
+     * @return int The number of slots, at least 1.
+     */
+    int width(const NodeType& node) const { return entries[slots.at(&node)].width; }
+
+    /**
+     * @brief Get the position of a node.
+     *
+     * @param node A laid-out node.
+     * @return Point The centre of the node.
+     */
+    Point position(const NodeType& node) {
+        refresh();
+        return entries[slots.at(&node)].position;
+    }
+
+    /**
+     * @brief Get the bounding box of the whole drawing.
+     *
+     * @param margin How far a node's drawing reaches beyond its centre.
+     * @return Box The box of all node centres grown by the margin, or an empty box at the
+     * origin for an empty layout.
+     */
+    Box extent(float margin) {
+        refresh();
+        if (entries.empty()) return Box{origin_x, origin_y, origin_x, origin_y};
+        return bounds(entries[0], margin);
+    }
+
+    /**
+     * @brief Get a counter that changes whenever the layout changes.
+     *
+     * @return std::size_t The revision, for callers that cache geometry built from the layout.
+     */
+    std::size_t version() const { return revision; }
+
+    /**
+     * @brief Call a function on every laid-out node, parents before children.
+     *
+     * @param fn The function, called as fn(node, position, parent_position); the root's
+     * parent position is its own position.
+     */
+    template <typename F>
+    void for_each(F fn) {
+        refresh();
+        for (const Entry& entry : entries) {
+            const Point& parent =
+                entry.parent == NONE ? entry.position : entries[entry.parent].position;
+            fn(*entry.node, entry.position, parent);
+        }
+    }
+
+    /**
+     * @brief Call functions on the nodes whose subtrees can be seen in a view.
+     *
+     * A subtree is visited when its bounding box, grown by the margin and stretched to reach
+     * the parent, overlaps the view, so every node and edge that may cross the view is
+     * reported. A visited subtree of more than one node whose node centres span less than
+     * min_extent in both directions is reported once through collapsed and not descended
+     * into; any other visited node is reported through visible. Nodes come parents first and
+     * siblings in child order, and the work is proportional to the number of visited nodes,
+     * not to the size of the tree.
+     *
+     * @param view The visible area.
+     * @param margin How far a node's drawing reaches beyond its centre.
+     * @param min_extent The smallest subtree size, in drawing units, that is descended into;
+     * 0 reports every visible node.
+     * @param visible Called as visible(node, position, parent_position); the root's parent
+     * position is its own position.
+     * @param collapsed Called as collapsed(node, box, parent_position) with the bounding box of
+     * the subtree grown by the margin.
+     */
+    template <typename Visible, typename Collapsed>
+    void for_each_in(const Box& view, float margin, float min_extent, Visible visible,
+                     Collapsed collapsed) {
+        refresh();
+        if (entries.empty()) return;
+        std::vector<std::size_t>& pending = query_stack;
+        pending.assign(1, 0);
+        while (!pending.empty()) {
+            const Entry& entry = entries[pending.back()];
+            pending.pop_back();
+            const Point& parent =
+                entry.parent == NONE ? entry.position : entries[entry.parent].position;
+            Box box = bounds(entry, margin);
+            Box reach = {std::min(box.left, parent.x), std::min(box.top, parent.y),
+                         std::max(box.right, parent.x), std::max(box.bottom, parent.y)};
+            if (reach.right < view.left || reach.left > view.right || reach.bottom < view.top ||
+                reach.top > view.bottom) {
+                continue;
+            }
+            if (entry.first_child != NONE && box.right - box.left - 2 * margin < min_extent &&
+                box.bottom - box.top - 2 * margin < min_extent) {
+                collapsed(*entry.node, box, parent);
+                continue;
+            }
+            visible(*entry.node, entry.position, parent);
+            std::size_t mark = pending.size();
+            for (std::size_t c = entry.first_child; c != NONE; c = entries[c].next_sibling) {
+                pending.push_back(c);
+            }
+            std::reverse(pending.begin() + mark, pending.end());
+        }
+    }
+
+private:
+    static const std::size_t NONE = static_cast<std::size_t>(-1); ///< Index meaning no entry.
+
+    /**
+     * @brief The cached layout of one node.
+     */
+    struct Entry {
+        NodeType* node;     ///< The node.
+        std::size_t parent; ///< Index of the parent entry, or NONE.
+        std::size_t first_child;  ///< Index of the first child entry, or NONE.
+        std::size_t last_child;   ///< Index of the last child entry, or NONE.
+        std::size_t next_sibling; ///< Index of the next sibling entry, or NONE.
+        int width;          ///< Width of the subtree in slots.
+        std::size_t depth;  ///< Depth of the node, set during refresh.
+        Point position;     ///< Centre of the node.
+        float next_child_x; ///< Position of the next child during refresh.
+        float min_x;        ///< Smallest horizontal node position in the subtree.
+        float max_x;        ///< Largest horizontal node position in the subtree.
+        float max_y;        ///< Largest vertical node position in the subtree.
+    };
+
+    float horizontal;                                       ///< Width of one slot.
+    float vertical;                                         ///< Distance between rows.
+    float origin_x;                                         ///< Horizontal position of the root.
+    float origin_y;                                         ///< Vertical position of the root.
+    NodeType* root;                                         ///< The laid-out root.
+    bool dirty;                                             ///< Whether positions are stale.
+    std::size_t revision;                                   ///< Change counter.
+    std::vector<Entry> entries;                             ///< Entries, parents before children.
+    std::unordered_map<const NodeType*, std::size_t> slots; ///< Entry index of each node.
+    std::vector<std::size_t> query_stack;                   ///< Reused stack of for_each_in.
+
+    /**
+     * @brief Get the bounding box of an entry's subtree.
+     *
+     * @param entry The subtree root, with a current position.
+     * @param margin How far to grow the box on every side.
+     * @return Box The box of the node centres in the subtree, grown by the margin.
+     */
+    Box bounds(const Entry& entry, float margin) const {
+        Box box = {entry.min_x - margin, entry.position.y - margin, entry.max_x + margin,
+                   entry.max_y + margin};
+        return box;
+    }
+
+    /**
+     * @brief Add entries for a subtree in pre-order and compute its widths.
+     *
+     * @param top The root of the subtree.
+     * @param parent The entry index of its parent, or NONE.
+     * @return std::size_t The entry index of the subtree root.
+     */
+    std::size_t add_subtree(NodeType* top, std::size_t parent) {
+        std::size_t first = entries.size();
+        std::vector<std::pair<NodeType*, std::size_t> > pending(1, std::make_pair(top, parent));
+        while (!pending.empty()) {
+            std::pair<NodeType*, std::size_t> item = pending.back();
+            pending.pop_back();
+            Entry entry = {item.first, item.second, NONE, NONE, NONE, 0, 0, {0, 0}, 0, 0, 0, 0};
+            std::size_t index = entries.size();
+            slots[item.first] = index;
+            entries.push_back(entry);
+            if (item.second != NONE) {
+                Entry& up = entries[item.second];
+                if (up.last_child == NONE) {
+                    up.first_child = index;
+                } else {
+                    entries[up.last_child].next_sibling = index;
+                }
+                up.last_child = index;
+            }
+            std::size_t mark = pending.size();
+            for (auto child : item.first->children) {
+                pending.push_back(std::make_pair(child, entries.size() - 1));
+            }
+            std::reverse(pending.begin() + mark, pending.end());
+        }
+        for (std::size_t i = entries.size(); i > first; --i) {
+            Entry& entry = entries[i - 1];
+            if (entry.width == 0) entry.width = 1;
+            if (i - 1 != first) {
+                Entry& up = entries[entry.parent];
+                up.width += entry.width;
+            }
+        }
+        return first;
+    }
+
+    /**
+     * @brief Recompute all positions and subtree boxes if the layout changed since they were
+     * last computed.
+     *
+     * Entries are in pre-order with attached subtrees appended, so every parent precedes its
+     * children and siblings appear in child order; one linear pass places every node, and one
+     * pass in reverse gathers the boxes.
+     */
+    void refresh() {
+        if (!dirty) return;
+        dirty = false;
+        for (Entry& entry : entries) {
+            if (entry.parent == NONE) {
+                entry.depth = 0;
+                entry.position = Point{origin_x, origin_y};
+            } else {
+                Entry& up = entries[entry.parent];
+                // Rows are computed from the depth rather than summed, so deep trees stay exact
+                entry.depth = up.depth + 1;
+                entry.position =
+                    Point{up.next_child_x, origin_y + static_cast<float>(entry.depth) * vertical};
+                up.next_child_x += entry.width * horizontal;
+            }
+            entry.next_child_x = entry.position.x - entry.width * horizontal / 2 + horizontal / 2;
+            entry.min_x = entry.max_x = entry.position.x;
+            entry.max_y = entry.position.y;
+        }
+        for (std::size_t i = entries.size(); i > 1; --i) {
+            const Entry& entry = entries[i - 1];
+            Entry& up = entries[entry.parent];
+            up.min_x = std::min(up.min_x, entry.min_x);
+            up.max_x = std::max(up.max_x, entry.max_x);
+            up.max_y = std::max(up.max_y, entry.max_y);
+        }
+    }
+};
+
+template <typename NodeType>
+const std::size_t TreeLayout<NodeType>::NONE;
+
+#endif // LAYOUT_HPP
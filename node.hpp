@@ -5,7 +5,10 @@
  * @version 1.0
  * @details
  * This file contains the declaration of the Node class, which is used to represent 
- * nodes in a tree structure. Each node stores a key of type T and has a list of child nodes.
+ * nodes in a tree structure. Each node stores a key of type T and has a list of child nodes,
+ * kept either in a std::vector or, when a fixed capacity is given, inline in the node. The
+ * SiblingNode class offers a first-child/next-sibling layout for wide, sparse trees, and the
+ * ParentNode class adds parent links for traversals that need no stack.
  * 
  * Contact: wasimshebalny@gmail.com
  */
@@ -14,7 +17,69 @@
 #define NODE_HPP
 
 #include <vector>
-#include <sstream>
+#include <string>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "key_format.hpp"
+
+/**
+ * @class InlineChildren
+ * @brief A fixed-capacity list of child pointers stored inline.
+ * 
+ * This class offers the subset of the std::vector interface that the tree uses, without any
+ * heap allocation.
+ * 
+ * @tparam P The child pointer type.
+ * @tparam N The maximum number of children.
+ */
+template <typename P, int N>
+class InlineChildren {
+public:
+    typedef P value_type;
+    typedef P* iterator;
+    typedef const P* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /**
+     * @brief Construct an empty list.
+     */
+    InlineChildren() : count(0) {}
+
+    /**
+     * @brief Append a child pointer.
+     * 
+     * @param child The child pointer to append.
+     * @throws std::length_error If the list already holds N children.
+     */
+    void push_back(P child) {
+        if (count == N) throw std::length_error("InlineChildren capacity exceeded");
+        items[count++] = child;
+    }
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return N; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+
+    P& operator[](std::size_t i) { return items[i]; }
+    const P& operator[](std::size_t i) const { return items[i]; }
+
+    iterator begin() { return items; }
+    iterator end() { return items + count; }
+    const_iterator begin() const { return items; }
+    const_iterator end() const { return items + count; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+private:
+    P items[N];         ///< The child pointers.
+    unsigned int count; ///< The number of children in use.
+};
 
 /**
  * @class Node
@@ -24,12 +89,20 @@
  * converting the node's key to a string representation.
  * 
  * @tparam T The type of the key stored in the node.
+ * @tparam N The inline child capacity. Default is 0, which stores children in a std::vector.
  */
-template <typename T>
+template <typename T, int N = 0>
 class Node {
+    static_assert(N >= 0, "the inline child capacity cannot be negative");
+
 public:
+    /// The container holding the child pointers.
+    typedef typename std::conditional<N == 0, std::vector<Node*>, InlineChildren<Node*, N> >::type children_type;
+
+    static const int child_capacity = N; ///< Maximum number of children, 0 if unbounded.
+
     T key; ///< The key stored in the node.
-    std::vector<Node<T>*> children; ///< The list of child nodes.
+    children_type children; ///< The list of child nodes.
 
     /**
      * @brief Construct a new Node object.
@@ -50,7 +123,143 @@ public:
      * 
      * @param child Pointer to the child node to be added.
      */
-    void add_child(Node<T>* child) { children.push_back(child); }
+    void add_child(Node* child) { children.push_back(child); }
+
+    /**
+     * @brief Convert the node's key to a string representation.
+     * 
+     * @return std::string The string representation of the node's key.
+     */
+    std::string toString() const {
+        std::string text;
+        append_key(text, key);
+        return text;
+    }
+};
+
+template <typename T, int N>
+const int Node<T, N>::child_capacity;
+
+/**
+ * @class SiblingList
+ * @brief A singly linked child list threaded through the children's next_sibling pointers.
+ * 
+ * The list itself is a single pointer to the first child. It can only be walked front to back,
+ * and size, indexing and push_back are linear in the number of children.
+ * 
+ * @tparam N The node type, which must have a next_sibling member.
+ */
+template <typename N>
+class SiblingList {
+public:
+    typedef N* value_type;
+
+    /**
+     * @class iterator
+     * @brief A forward iterator over the children.
+     */
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef N* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef N* const* pointer;
+        typedef N* reference;
+
+        iterator(N* node = nullptr) : node(node) {}
+        N* operator*() const { return node; }
+        iterator& operator++() { node = node->next_sibling; return *this; }
+        iterator operator++(int) { iterator old = *this; node = node->next_sibling; return old; }
+        bool operator==(const iterator& other) const { return node == other.node; }
+        bool operator!=(const iterator& other) const { return node != other.node; }
+
+    private:
+        N* node; ///< The current child.
+    };
+    typedef iterator const_iterator;
+
+    /**
+     * @brief Construct an empty list.
+     */
+    SiblingList() : first(nullptr) {}
+
+    /**
+     * @brief Append a child at the end of the list.
+     * 
+     * @param child The child to append. It must not be linked into another list.
+     */
+    void push_back(N* child) {
+        if (!first) {
+            first = child;
+            return;
+        }
+        N* last = first;
+        while (last->next_sibling) last = last->next_sibling;
+        last->next_sibling = child;
+    }
+
+    std::size_t size() const {
+        std::size_t count = 0;
+        for (N* node = first; node; node = node->next_sibling) ++count;
+        return count;
+    }
+
+    bool empty() const { return first == nullptr; }
+
+    N* operator[](std::size_t i) const {
+        N* node = first;
+        while (i--) node = node->next_sibling;
+        return node;
+    }
+
+    N* front() const { return first; }
+    iterator begin() const { return iterator(first); }
+    iterator end() const { return iterator(); }
+
+private:
+    N* first; ///< The first child, or nullptr.
+};
+
+/**
+ * @class SiblingNode
+ * @brief A tree node in first-child/next-sibling form.
+ * 
+ * Each node holds its key and two pointers, with no per-node heap allocation, which makes it
+ * the most compact layout for trees whose nodes have few children on average.
+ * 
+ * @tparam T The type of the key stored in the node.
+ */
+template <typename T>
+class SiblingNode {
+public:
+    typedef SiblingList<SiblingNode> children_type; ///< The list holding the children.
+
+    static const int child_capacity = 0; ///< Maximum number of children, 0 if unbounded.
+
+    T key; ///< The key stored in the node.
+    children_type children; ///< The list of child nodes.
+    SiblingNode* next_sibling; ///< The next child of this node's parent.
+
+    /**
+     * @brief Construct a new SiblingNode object.
+     * 
+     * @param key The key to be stored in the node.
+     */
+    SiblingNode(T key) : key(key), next_sibling(nullptr) {}
+
+    /**
+     * @brief Get the key stored in the node.
+     * 
+     * @return T The key stored in the node.
+     */
+    T get_key() const { return key; }
+
+    /**
+     * @brief Add a child node after the current last child.
+     * 
+     * @param child Pointer to the child node to be added.
+     */
+    void add_child(SiblingNode* child) { children.push_back(child); }
 
     /**
      * @brief Convert the node's key to a string representation.
@@ -58,10 +267,95 @@ public:
      * @return std::string The string representation of the node's key.
      */
     std::string toString() const {
-        std::stringstream ss;
-        ss << key;
-        return ss.str();
+        std::string text;
+        append_key(text, key);
+        return text;
     }
 };
 
+template <typename T>
+const int SiblingNode<T>::child_capacity;
+
+/**
+ * @class ParentNode
+ * @brief A tree node that also links back to its parent.
+ * 
+ * Besides the children, each node stores its parent and its position among the parent's
+ * children, which lets the tree walk from any node to its successor without a stack.
+ * 
+ * @tparam T The type of the key stored in the node.
+ */
+template <typename T>
+class ParentNode {
+public:
+    typedef std::vector<ParentNode*> children_type; ///< The container holding the child pointers.
+
+    static const int child_capacity = 0; ///< Maximum number of children, 0 if unbounded.
+
+    T key; ///< The key stored in the node.
+    children_type children; ///< The list of child nodes.
+    ParentNode* parent; ///< The parent node, or nullptr for a root.
+    std::size_t child_index; ///< Position of this node in its parent's children.
+
+    /**
+     * @brief Construct a new ParentNode object.
+     * 
+     * @param key The key to be stored in the node.
+     */
+    ParentNode(T key) : key(key), parent(nullptr), child_index(0) {}
+
+    /**
+     * @brief Get the key stored in the node.
+     * 
+     * @return T The key stored in the node.
+     */
+    T get_key() const { return key; }
+
+    /**
+     * @brief Add a child node and link it back to this node.
+     * 
+     * @param child Pointer to the child node to be added.
+     */
+    void add_child(ParentNode* child) {
+        child->parent = this;
+        child->child_index = children.size();
+        children.push_back(child);
+    }
+
+    /**
+     * @brief Convert the node's key to a string representation.
+     * 
+     * @return std::string The string representation of the node's key.
+     */
+    std::string toString() const {
+        std::string text;
+        append_key(text, key);
+        return text;
+    }
+};
+
+template <typename T>
+const int ParentNode<T>::child_capacity;
+
+/**
+ * @brief Get the heap memory held by a child container.
+ * 
+ * @param children A std::vector of child pointers.
+ * @return std::size_t The bytes allocated by the vector.
+ */
+template <typename P>
+std::size_t child_heap_bytes(const std::vector<P>& children) {
+    return children.capacity() * sizeof(P);
+}
+
+/**
+ * @brief Get the heap memory held by a child container that stores nothing on the heap.
+ * 
+ * @return std::size_t Always 0.
+ */
+template <typename C>
+std::size_t child_heap_bytes(const C&) {
+    return 0;
+}
+
 #endif // NODE_HPP
@@ -0,0 +1,144 @@
+/**
+ * @file node_arena.hpp
+ * @brief Declaration of the NodeArena class for chunked, tree-owned node storage.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the declaration of the NodeArena class, a slab allocator that constructs
+ * nodes in large contiguous chunks. Nodes keep stable addresses for the lifetime of the arena
+ * and are all destroyed at once when the arena goes away, so building and tearing down large
+ * trees costs one allocation per chunk instead of one per node.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef NODE_ARENA_HPP
+#define NODE_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class NodeArena
+ * @brief A chunked arena that owns nodes.
+ *
+ * Chunks start small and double in size up to a fixed cap, so small trees stay small and large
+ * trees need only a handful of allocations.
+ *
+ * @tparam NodeType The type of the nodes stored in the arena.
+ */
+template <typename NodeType>
+class NodeArena {
+public:
+    static const std::size_t MIN_CHUNK = 64;      ///< Capacity of the first chunk.
+    static const std::size_t MAX_CHUNK = 1 << 16; ///< Capacity cap for grown chunks.
+
+    /**
+     * @brief Construct an empty arena.
+     */
+    NodeArena() : count(0), next_capacity(MIN_CHUNK) {}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /**
+     * @brief Destroy the arena and every node it owns.
+     */
+    ~NodeArena() {
+        for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+            NodeType* nodes = reinterpret_cast<NodeType*>(it->storage.get());
+            for (std::size_t i = it->used; i > 0; --i) {
+                nodes[i - 1].~NodeType();
+            }
+        }
+    }
+
+    /**
+     * @brief Construct a new node in the arena.
+     *
+     * @param args The arguments forwarded to the node constructor.
+     * @return NodeType* Pointer to the new node, valid for the lifetime of the arena.
+     */
+    template <typename... Args>
+    NodeType* create(Args&&... args) {
+        if (chunks.empty() || chunks.back().used == chunks.back().capacity) {
+            add_chunk(next_capacity);
+            if (next_capacity < MAX_CHUNK) next_capacity *= 2;
+        }
+        Chunk& chunk = chunks.back();
+        NodeType* node = reinterpret_cast<NodeType*>(chunk.storage.get()) + chunk.used;
+        new (node) NodeType(std::forward<Args>(args)...);
+        ++chunk.used;
+        ++count;
+        return node;
+    }
+
+    /**
+     * @brief Make room for at least the given number of additional nodes in one chunk.
+     *
+     * @param additional The number of nodes about to be created.
+     */
+    void reserve(std::size_t additional) {
+        std::size_t room = chunks.empty() ? 0 : chunks.back().capacity - chunks.back().used;
+        if (additional > room) add_chunk(additional);
+    }
+
+    /**
+     * @brief Get the number of nodes in the arena.
+     *
+     * @return std::size_t The number of nodes created so far.
+     */
+    std::size_t size() const { return count; }
+
+    /**
+     * @brief Get the number of bytes reserved for node storage.
+     *
+     * @return std::size_t The total capacity of all chunks in bytes.
+     */
+    std::size_t capacity_bytes() const {
+        std::size_t bytes = 0;
+        for (auto& chunk : chunks) bytes += chunk.capacity * sizeof(NodeType);
+        return bytes;
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof(NodeType), alignof(NodeType)>::type Slot;
+
+    /**
+     * @brief A contiguous block of node slots.
+     */
+    struct Chunk {
+        std::unique_ptr<Slot[]> storage; ///< Raw storage for the nodes.
+        std::size_t capacity;            ///< Number of slots in the chunk.
+        std::size_t used;                ///< Number of constructed nodes.
+    };
+
+    std::vector<Chunk> chunks; ///< Chunks in allocation order.
+    std::size_t count;         ///< Total number of constructed nodes.
+    std::size_t next_capacity; ///< Capacity of the next grown chunk.
+
+    /**
+     * @brief Append a new chunk.
+     *
+     * @param capacity The number of slots in the new chunk.
+     */
+    void add_chunk(std::size_t capacity) {
+        Chunk chunk;
+        chunk.storage.reset(new Slot[capacity]);
+        chunk.capacity = capacity;
+        chunk.used = 0;
+        chunks.push_back(std::move(chunk));
+    }
+};
+
+template <typename NodeType>
+const std::size_t NodeArena<NodeType>::MIN_CHUNK;
+
+template <typename NodeType>
+const std::size_t NodeArena<NodeType>::MAX_CHUNK;
+
+#endif // NODE_ARENA_HPP
@@ -0,0 +1,299 @@
+/**
+ * @file parallel.hpp
+ * @brief Declaration of the WorkStealingPool and TaskGroup classes for parallel tree walks.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains a small work-stealing thread pool built on std::thread. Every worker owns
+ * a task deque: it pops its own newest tasks first, which keeps a subtree on the thread that
+ * discovered it, and steals the oldest tasks of other workers when it runs dry, which hands
+ * out the largest remaining subtrees. A TaskGroup tracks a batch of tasks and lets the caller
+ * help run them while it waits, so groups can be waited on from inside pool tasks as well.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief A fixed-size thread pool with one task deque per worker.
+ */
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task; ///< A unit of work.
+
+    /**
+     * @brief Start the worker threads.
+     *
+     * @param threads The number of workers; 0 uses std::thread::hardware_concurrency().
+     */
+    explicit WorkStealingPool(std::size_t threads = 0) : stopping(false), queued(0), next_queue(0) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+        for (std::size_t i = 0; i < threads; ++i) {
+            queues.push_back(std::unique_ptr<Queue>(new Queue));
+        }
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.push_back(std::thread(&WorkStealingPool::worker_loop, this, i));
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Stop and join the workers. Tasks still queued are discarded.
+     */
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    /**
+     * @brief Get the shared pool used when no pool is given explicitly.
+     *
+     * @return WorkStealingPool& A pool with one worker per hardware thread.
+     */
+    static WorkStealingPool& shared() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Get the number of workers.
+     *
+     * @return std::size_t The number of worker threads.
+     */
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Get the number of tasks waiting in the deques.
+     *
+     * @return std::size_t The number of queued tasks.
+     */
+    std::size_t pending() const { return queued.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Queue a task.
+     *
+     * Workers push onto their own deque; other threads spread tasks round-robin.
+     *
+     * @param task The task to run.
+     */
+    void submit(Task task) {
+        std::size_t index = current_worker() >= 0 ? static_cast<std::size_t>(current_worker())
+                                                  : next_queue.fetch_add(1) % queues.size();
+        {
+            // Count the task before it becomes visible, so a thief's decrement never comes first
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queued.fetch_add(1);
+            try {
+                queues[index]->tasks.push_back(std::move(task));
+            } catch (...) {
+                queued.fetch_sub(1);
+                throw;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * @brief Run one queued task on the calling thread, if there is any.
+     *
+     * @return true If a task was run.
+     * @return false If every deque was empty.
+     */
+    bool run_one() {
+        Task task;
+        if (!take(task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    /**
+     * @brief A worker's task deque.
+     */
+    struct Queue {
+        std::mutex mutex;       ///< Guards the deque.
+        std::deque<Task> tasks; ///< Tasks, newest at the back.
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues; ///< One deque per worker.
+    std::vector<std::thread> workers;           ///< The worker threads.
+    std::mutex sleep_mutex;                     ///< Guards sleeping and stopping.
+    std::condition_variable wake;               ///< Wakes idle workers.
+    bool stopping;                              ///< Set when the pool shuts down.
+    std::atomic<std::size_t> queued;            ///< Number of queued tasks.
+    std::atomic<std::size_t> next_queue;        ///< Round-robin cursor for outside submitters.
+
+    /**
+     * @brief Get the worker index of the calling thread in this pool.
+     *
+     * @return int The index, or -1 for threads that are not workers of this pool.
+     */
+    int current_worker() const {
+        return worker_pool() == this ? worker_index() : -1;
+    }
+
+    static const WorkStealingPool*& worker_pool() {
+        static thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+
+    static int& worker_index() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    /**
+     * @brief Take a task: the newest from the caller's own deque, else the oldest of another.
+     *
+     * @param task Receives the task.
+     * @return true If a task was taken.
+     * @return false If every deque was empty.
+     */
+    bool take(Task& task) {
+        if (queued.load() == 0) return false;
+        int self = current_worker();
+        if (self >= 0) {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        std::size_t start = self >= 0 ? static_cast<std::size_t>(self) + 1 : 0;
+        for (std::size_t i = 0; i < queues.size(); ++i) {
+            Queue& victim = *queues[(start + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief The body of a worker thread.
+     *
+     * @param index The worker's index.
+     */
+    void worker_loop(std::size_t index) {
+        worker_pool() = this;
+        worker_index() = static_cast<int>(index);
+        while (true) {
+            if (run_one()) continue;
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            if (stopping) return;
+        }
+    }
+};
+
+/**
+ * @class TaskGroup
+ * @brief A batch of pool tasks that can be waited on together.
+ *
+ * If a task throws, the first exception is kept and rethrown by wait once every task of the
+ * group has finished.
+ */
+class TaskGroup {
+public:
+    /**
+     * @brief Construct an empty group.
+     *
+     * @param pool The pool that runs the tasks.
+     */
+    explicit TaskGroup(WorkStealingPool& pool) : pool(pool), outstanding(0) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief Queue a task in the group.
+     *
+     * @param task The task to run.
+     * @throws std::bad_alloc If the task cannot be queued; the group then does not wait for it.
+     */
+    template <typename F>
+    void run(F task) {
+        outstanding.fetch_add(1);
+        try {
+            pool.submit([this, task]() {
+                try {
+                    task();
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+                outstanding.fetch_sub(1);
+            });
+        } catch (...) {
+            outstanding.fetch_sub(1);
+            throw;
+        }
+    }
+
+    /**
+     * @brief Record a failure to be rethrown by wait.
+     *
+     * @param error The exception.
+     */
+    void fail(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!first_error) first_error = error;
+    }
+
+    /**
+     * @brief Wait for every task of the group, running queued tasks meanwhile.
+     */
+    void wait() {
+        while (outstanding.load() > 0) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+        if (first_error) std::rethrow_exception(first_error);
+    }
+
+    /**
+     * @brief Get the pool running the group.
+     *
+     * @return WorkStealingPool& The pool.
+     */
+    WorkStealingPool& executor() { return pool; }
+
+private:
+    WorkStealingPool& pool;               ///< The pool running the tasks.
+    std::atomic<std::size_t> outstanding; ///< Tasks queued or running.
+    std::mutex error_mutex;               ///< Guards first_error.
+    std::exception_ptr first_error;       ///< The first exception thrown by a task.
+};
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,98 @@
+/**
+ * @file scratch_vector.hpp
+ * @brief Declaration of the ScratchVector class, a vector that borrows its storage from a pool.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the ScratchVector class used by the tree iterators for their stacks and
+ * queues. A ScratchVector constructed with a home vector takes over that vector's storage and
+ * hands it back, emptied but with its capacity, when it is destroyed, so traversals that are
+ * started again and again with the same home reuse one allocation instead of growing a fresh
+ * container each time. Without a home it is an ordinary vector.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef SCRATCH_VECTOR_HPP
+#define SCRATCH_VECTOR_HPP
+
+#include <utility>
+#include <vector>
+
+/**
+ * @class ScratchVector
+ * @brief A std::vector that borrows its storage from a home vector for its lifetime.
+ *
+ * Copies get storage of their own; moves carry the borrowed storage and the duty to return
+ * it. If the home is borrowed twice at once, the second borrower finds it empty and simply
+ * allocates, so sharing a home is always safe, only not free.
+ *
+ * @tparam E The element type.
+ */
+template <typename E>
+class ScratchVector : public std::vector<E> {
+public:
+    /**
+     * @brief Construct an empty vector, borrowing the storage of the home vector if given.
+     *
+     * @param home The vector to borrow from and return to, or nullptr.
+     */
+    explicit ScratchVector(std::vector<E>* home = nullptr) : home(home) {
+        if (home) {
+            this->swap(*home);
+            this->clear();
+        }
+    }
+
+    /**
+     * @brief Copy the elements into storage of its own.
+     *
+     * @param other The vector to copy.
+     */
+    ScratchVector(const ScratchVector& other) : std::vector<E>(other), home(nullptr) {}
+
+    /**
+     * @brief Take over the elements and the borrowed storage.
+     *
+     * @param other The vector to move from.
+     */
+    ScratchVector(ScratchVector&& other) : std::vector<E>(std::move(other)), home(other.home) {
+        other.home = nullptr;
+    }
+
+    /**
+     * @brief Return the current storage and take over the other vector's.
+     *
+     * @param other The vector to take from.
+     * @return ScratchVector& Reference to this vector.
+     */
+    ScratchVector& operator=(ScratchVector other) {
+        release();
+        this->swap(other);
+        home = other.home;
+        other.home = nullptr;
+        return *this;
+    }
+
+    /**
+     * @brief Return the borrowed storage.
+     */
+    ~ScratchVector() {
+        release();
+    }
+
+private:
+    std::vector<E>* home; ///< The vector the storage is returned to, or nullptr.
+
+    /**
+     * @brief Hand the storage back to the home vector, emptied.
+     */
+    void release() {
+        if (!home) return;
+        this->clear();
+        home->swap(*this);
+        home = nullptr;
+    }
+};
+
+#endif // SCRATCH_VECTOR_HPP
@@ -16,6 +16,18 @@
 #include "tree.hpp"
 #include "node.hpp"
 #include "complex.hpp"
+#include "columnar_keys.hpp"
+#include "tree_file.hpp"
+#include "layout.hpp"
+#include "tree_geometry.hpp"
+#include "tree_svg.hpp"
+#include "generator.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 /**
  * @brief Test case for adding children to nodes.
@@ -308,3 +320,1698 @@ TEST_CASE("Double type operations") {
         CHECK(result == expected);
     }
 }
+
+/**
+ * @brief A key type without a std::hash specialization.
+ */
+struct Unhashable {
+    int value;
+    bool operator==(const Unhashable& other) const { return value == other.value; }
+};
+
+/**
+ * @brief Test case for the optional key index.
+ */
+TEST_CASE("key index") {
+    Node<int> root(10);
+    Tree<int, 3> tree;
+    tree.add_root(root);
+    tree.enable_key_index();
+
+    Node<int> child1(20);
+    Node<int> child2(15);
+    Node<int> child3(25);
+    Node<int> child4(30);
+    Node<int> missing(99);
+    Node<int> orphan(40);
+
+    tree.add_sub_node(root, child1);
+    tree.add_sub_node(root, child2);
+    tree.add_sub_node(child1, child3);
+    tree.add_sub_node(child3, child4);
+    Node<int>* orphan_parent = tree.add_sub_node(missing, orphan);
+
+    SUBCASE("parents are resolved through the index") {
+        CHECK(tree.has_key_index());
+        CHECK(child1.children.size() == 1);
+        CHECK(child3.children.size() == 1);
+        CHECK(child3.children[0] == &child4);
+        CHECK(orphan_parent == nullptr);
+        bool attached = false;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) {
+            for (auto child : it->children) attached = attached || child == &orphan;
+        }
+        CHECK_FALSE(attached);
+
+        std::vector<int> expected = {10, 20, 25, 30, 15};
+        std::vector<int> result;
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == expected);
+    }
+
+    SUBCASE("enabling on an existing tree indexes all nodes") {
+        tree.disable_key_index();
+        CHECK_FALSE(tree.has_key_index());
+        tree.enable_key_index();
+
+        Node<int> child5(35);
+        tree.add_sub_node(child4, child5);
+        CHECK(child4.children.size() == 1);
+    }
+
+    SUBCASE("pre-linked subtrees are indexed when attached") {
+        Node<int> sub(50);
+        Node<int> sub_child(60);
+        Node<int> leaf(70);
+        sub.add_child(&sub_child);
+        tree.add_sub_node(child2, sub);
+        tree.add_sub_node(sub_child, leaf);
+        CHECK(sub_child.children.size() == 1);
+    }
+
+    SUBCASE("unhashable keys keep using find_node") {
+        Node<Unhashable> top(Unhashable{1});
+        Node<Unhashable> inner(Unhashable{2});
+        Node<Unhashable> leaf(Unhashable{3});
+        Tree<Unhashable, 2> plain;
+        plain.add_root(top);
+        plain.enable_key_index();
+        CHECK_FALSE(plain.has_key_index());
+        CHECK(plain.add_sub_node(top, inner) == &top);
+        CHECK(plain.add_sub_node(inner, leaf) == &inner);
+        CHECK(inner.children.size() == 1);
+    }
+}
+
+/**
+ * @brief Test case for tree-owned nodes created in the arena.
+ */
+TEST_CASE("arena nodes") {
+    Tree<int> tree;
+    Node<int>& root = tree.emplace_root(10);
+    Node<int>* child1 = tree.emplace_sub_node(root, 20);
+    Node<int>* child2 = tree.emplace_sub_node(root, 15);
+
+    SUBCASE("emplaced nodes are linked") {
+        REQUIRE(child1 != nullptr);
+        REQUIRE(child2 != nullptr);
+        tree.emplace_sub_node(*child1, 25);
+        tree.emplace_sub_node(*child1, 30);
+
+        std::vector<int> expected = {10, 20, 15, 25, 30};
+        std::vector<int> result;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == expected);
+    }
+
+    SUBCASE("fan-out limit") {
+        CHECK(tree.emplace_sub_node(root, 40) == nullptr);
+        CHECK(root.children.size() == 2);
+    }
+
+    SUBCASE("addresses stay stable across chunks") {
+        tree.reserve(10);
+        Node<int>* parent = child1;
+        std::vector<Node<int>*> chain;
+        for (int i = 0; i < 1000; ++i) {
+            parent = tree.emplace_sub_node(*parent, 100 + i);
+            chain.push_back(parent);
+        }
+        for (int i = 0; i < 1000; ++i) {
+            CHECK(chain[i]->get_key() == 100 + i);
+        }
+        tree.enable_key_index();
+        Node<int> extra(5000);
+        Node<int> lookup(1099);
+        tree.add_sub_node(lookup, extra);
+        CHECK(chain.back()->children.size() == 1);
+    }
+}
+
+/**
+ * @brief Test case for nodes with inline child storage.
+ */
+TEST_CASE("inline children") {
+    Node<int, 2> root(10);
+    InlineTree<int, 2> tree;
+    tree.add_root(root);
+
+    Node<int, 2> child1(20);
+    Node<int, 2> child2(15);
+    Node<int, 2> child3(25);
+    Node<int, 2> child4(30);
+    Node<int, 2> child5(35);
+
+    tree.add_sub_node(root, child1);
+    tree.add_sub_node(root, child2);
+    tree.add_sub_node(child1, child3);
+    tree.add_sub_node(child1, child4);
+    tree.add_sub_node(child1, child5);
+
+    SUBCASE("fan-out limit") {
+        CHECK(root.children.size() == 2);
+        CHECK(child1.children.size() == 2);
+        CHECK(child1.children.capacity() == 2);
+        CHECK_THROWS_AS(child1.add_child(&child5), std::length_error);
+    }
+
+    SUBCASE("traversals match the vector layout") {
+        std::vector<int> result;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 15, 25, 30});
+
+        result.clear();
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 25, 30, 15});
+
+        result.clear();
+        for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{25, 20, 30, 10, 15});
+
+        result.clear();
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{25, 30, 20, 15, 10});
+
+        result.clear();
+        for (auto it = tree.begin_min_heap(); it != tree.end_min_heap(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 15, 20, 25, 30});
+    }
+
+    SUBCASE("arena nodes") {
+        InlineTree<int, 3> owned;
+        Node<int, 3>& owned_root = owned.emplace_root(1);
+        owned.emplace_sub_node(owned_root, 2);
+        owned.emplace_sub_node(owned_root, 3);
+        owned.emplace_sub_node(owned_root, 4);
+        CHECK(owned.emplace_sub_node(owned_root, 5) == nullptr);
+        CHECK(owned_root.children.size() == 3);
+    }
+}
+
+/**
+ * @brief Test case for first-child/next-sibling nodes.
+ */
+TEST_CASE("sibling nodes") {
+    SiblingNode<int> root(10);
+    SiblingTree<int, 3> tree;
+    tree.add_root(root);
+
+    SiblingNode<int> child1(20);
+    SiblingNode<int> child2(15);
+    SiblingNode<int> child3(25);
+    SiblingNode<int> child4(30);
+    SiblingNode<int> child5(12);
+
+    tree.add_sub_node(root, child1);
+    tree.add_sub_node(root, child2);
+    tree.add_sub_node(child1, child3);
+    tree.add_sub_node(child1, child4);
+    tree.add_sub_node(root, child5);
+
+    SUBCASE("children are linked in order") {
+        CHECK(root.children.size() == 3);
+        CHECK(root.children.front() == &child1);
+        CHECK(child1.next_sibling == &child2);
+        CHECK(child2.next_sibling == &child5);
+        CHECK(root.children[2] == &child5);
+    }
+
+    SUBCASE("fan-out limit") {
+        SiblingNode<int> extra(40);
+        tree.add_sub_node(root, extra);
+        CHECK(root.children.size() == 3);
+    }
+
+    SUBCASE("all traversals") {
+        std::vector<int> result;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 15, 12, 25, 30});
+
+        result.clear();
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 25, 30, 15, 12});
+
+        result.clear();
+        for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{25, 20, 30, 10, 15});
+
+        result.clear();
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{25, 30, 20, 15, 12, 10});
+
+        result.clear();
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 25, 30, 15, 12});
+
+        result.clear();
+        for (auto it = tree.begin_min_heap(); it != tree.end_min_heap(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 12, 15, 20, 25, 30});
+    }
+
+    SUBCASE("memory report") {
+        CHECK(tree.memory_usage() == 6 * sizeof(SiblingNode<int>));
+
+        Tree<int, 3> vector_tree;
+        Node<int>& vector_root = vector_tree.emplace_root(1);
+        vector_tree.emplace_sub_node(vector_root, 2);
+        CHECK(vector_tree.memory_usage() >= 2 * sizeof(Node<int>) + sizeof(Node<int>*));
+    }
+}
+
+/**
+ * @brief Test case for the lazy post-order iterator.
+ */
+TEST_CASE("lazy post-order") {
+    Tree<int, 3> tree;
+    Node<int>& root = tree.emplace_root(1);
+    Node<int>* a = tree.emplace_sub_node(root, 2);
+    Node<int>* b = tree.emplace_sub_node(root, 3);
+    tree.emplace_sub_node(root, 4);
+    tree.emplace_sub_node(*a, 5);
+    Node<int>* c = tree.emplace_sub_node(*a, 6);
+    tree.emplace_sub_node(*c, 7);
+    tree.emplace_sub_node(*b, 8);
+
+    SUBCASE("order") {
+        std::vector<int> expected = {5, 7, 6, 2, 8, 3, 4, 1};
+        std::vector<int> result;
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == expected);
+    }
+
+    SUBCASE("single node and empty tree") {
+        Tree<int> single;
+        single.emplace_root(42);
+        auto it = single.begin_post_order();
+        REQUIRE(it != single.end_post_order());
+        CHECK(it->get_key() == 42);
+        ++it;
+        CHECK_FALSE(it != single.end_post_order());
+
+        Tree<int> empty;
+        CHECK_FALSE(empty.begin_post_order() != empty.end_post_order());
+    }
+
+    SUBCASE("early exit on a deep chain") {
+        Tree<int> chain;
+        Node<int>* node = &chain.emplace_root(0);
+        for (int i = 1; i < 100000; ++i) {
+            node = chain.emplace_sub_node(*node, i);
+        }
+        auto it = chain.begin_post_order();
+        CHECK(it->get_key() == 99999);
+        ++it;
+        CHECK(it->get_key() == 99998);
+    }
+}
+
+/**
+ * @brief Test case for partial min-order queries.
+ */
+TEST_CASE("partial min-order") {
+    Tree<int, 3> heap_tree;
+    Node<int>& heap_root = heap_tree.emplace_root(1);
+    Node<int>* a = heap_tree.emplace_sub_node(heap_root, 5);
+    Node<int>* b = heap_tree.emplace_sub_node(heap_root, 2);
+    heap_tree.emplace_sub_node(*a, 6);
+    heap_tree.emplace_sub_node(*a, 9);
+    Node<int>* c = heap_tree.emplace_sub_node(*b, 3);
+    heap_tree.emplace_sub_node(*c, 4);
+    heap_tree.emplace_sub_node(*b, 8);
+
+    Tree<int> plain;
+    Node<int>& plain_root = plain.emplace_root(10);
+    Node<int>* d = plain.emplace_sub_node(plain_root, 20);
+    plain.emplace_sub_node(plain_root, 15);
+    plain.emplace_sub_node(*d, 5);
+    plain.emplace_sub_node(*d, 30);
+
+    SUBCASE("frontier order on a heap-ordered tree") {
+        CHECK(heap_tree.is_heap_ordered());
+        std::vector<int> expected = {1, 2, 3, 4, 5, 6, 8, 9};
+        std::vector<int> result;
+        for (auto it = heap_tree.begin_frontier(); it != heap_tree.end_frontier(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == expected);
+    }
+
+    SUBCASE("smallest on any tree") {
+        CHECK_FALSE(plain.is_heap_ordered());
+        std::vector<int> result;
+        for (auto node : plain.smallest(3)) result.push_back(node->get_key());
+        CHECK(result == std::vector<int>{5, 10, 15});
+
+        result.clear();
+        for (auto node : plain.smallest(10)) result.push_back(node->get_key());
+        CHECK(result == std::vector<int>{5, 10, 15, 20, 30});
+
+        CHECK(plain.smallest(0).empty());
+        CHECK(Tree<int>().smallest(4).empty());
+    }
+
+    SUBCASE("smallest agrees with the frontier order") {
+        std::vector<int> frontier;
+        for (auto it = heap_tree.begin_frontier(); it != heap_tree.end_frontier() && frontier.size() < 4; ++it) {
+            frontier.push_back(it->get_key());
+        }
+        std::vector<int> selected;
+        for (auto node : heap_tree.smallest(4)) selected.push_back(node->get_key());
+        CHECK(frontier == selected);
+    }
+}
+
+/**
+ * @brief Test case for stackless traversals over parent-linked nodes.
+ */
+TEST_CASE("stackless traversals") {
+    ParentTree<int, 3> tree;
+    ParentNode<int>& root = tree.emplace_root(1);
+    ParentNode<int>* a = tree.emplace_sub_node(root, 2);
+    ParentNode<int>* b = tree.emplace_sub_node(root, 3);
+    tree.emplace_sub_node(root, 4);
+    tree.emplace_sub_node(*a, 5);
+    ParentNode<int>* c = tree.emplace_sub_node(*a, 6);
+    tree.emplace_sub_node(*c, 7);
+    tree.emplace_sub_node(*b, 8);
+
+    SUBCASE("parent links") {
+        CHECK(root.parent == nullptr);
+        CHECK(c->parent == a);
+        CHECK(c->child_index == 1);
+        CHECK(b->child_index == 1);
+    }
+
+    SUBCASE("pre-order matches the stack-based iterator") {
+        std::vector<int> expected;
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) expected.push_back(it->get_key());
+        std::vector<int> result;
+        for (auto it = tree.begin_stackless_pre_order(); it != tree.end_stackless_pre_order(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == std::vector<int>{1, 2, 5, 6, 7, 3, 8, 4});
+        CHECK(result == expected);
+    }
+
+    SUBCASE("post-order matches the stack-based iterator") {
+        std::vector<int> expected;
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) expected.push_back(it->get_key());
+        std::vector<int> result;
+        for (auto it = tree.begin_stackless_post_order(); it != tree.end_stackless_post_order(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == std::vector<int>{5, 7, 6, 2, 8, 3, 4, 1});
+        CHECK(result == expected);
+    }
+
+    SUBCASE("subtree roots stop the walk") {
+        ParentTree<int, 3> subtree;
+        subtree.add_root(*a);
+        std::vector<int> result;
+        for (auto it = subtree.begin_stackless_pre_order(); it != subtree.end_stackless_pre_order(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == std::vector<int>{2, 5, 6, 7});
+
+        result.clear();
+        for (auto it = subtree.begin_stackless_post_order(); it != subtree.end_stackless_post_order(); ++it) {
+            result.push_back(it->get_key());
+        }
+        CHECK(result == std::vector<int>{5, 7, 6, 2});
+    }
+}
+
+/**
+ * @brief Test case for frozen breadth-first snapshots.
+ */
+TEST_CASE("frozen snapshot") {
+    Tree<int, 3> tree;
+    Node<int>& root = tree.emplace_root(10);
+    Node<int>* a = tree.emplace_sub_node(root, 20);
+    Node<int>* b = tree.emplace_sub_node(root, 15);
+    tree.emplace_sub_node(*a, 25);
+    tree.emplace_sub_node(*a, 30);
+    tree.emplace_sub_node(*a, 5);
+    tree.emplace_sub_node(*b, 12);
+
+    FrozenTree<int> frozen = tree.freeze();
+
+    SUBCASE("layout") {
+        REQUIRE(frozen.size() == 7);
+        CHECK(frozen.max_children() == 3);
+        CHECK(frozen.keys() == std::vector<int>{10, 20, 15, 25, 30, 5, 12});
+        CHECK(frozen.child_count(0) == 2);
+        CHECK(frozen.first_child(1) == 3);
+        CHECK(frozen.child_count(1) == 3);
+        CHECK(frozen.first_child(2) == 6);
+        CHECK(frozen.child_count(6) == 0);
+    }
+
+    SUBCASE("traversals match the tree iterators") {
+        std::vector<int> expected;
+        std::vector<int> result;
+        auto collect = [&result](const int& key) { result.push_back(key); };
+
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) expected.push_back(it->get_key());
+        frozen.for_each(Traversal::BFS, collect);
+        CHECK(result == expected);
+
+        expected.clear();
+        result.clear();
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) expected.push_back(it->get_key());
+        frozen.for_each(Traversal::DFS, collect);
+        CHECK(result == expected);
+
+        expected.clear();
+        result.clear();
+        for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it) expected.push_back(it->get_key());
+        frozen.for_each(Traversal::InOrder, collect);
+        CHECK(result == expected);
+
+        expected.clear();
+        result.clear();
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) expected.push_back(it->get_key());
+        frozen.for_each(Traversal::PostOrder, collect);
+        CHECK(result == expected);
+
+        expected.clear();
+        result.clear();
+        for (auto it = tree.begin_min_heap(); it != tree.end_min_heap(); ++it) expected.push_back(it->get_key());
+        frozen.for_each(Traversal::MinHeap, collect);
+        CHECK(result == expected);
+    }
+
+    SUBCASE("empty tree") {
+        FrozenTree<int> none = Tree<int>().freeze();
+        CHECK(none.empty());
+        int calls = 0;
+        none.for_each(Traversal::PostOrder, [&calls](const int&) { ++calls; });
+        CHECK(calls == 0);
+    }
+}
+
+/**
+ * @brief Test case for columnar key scans.
+ */
+TEST_CASE("columnar keys") {
+    SUBCASE("int") {
+        std::vector<int> keys = {7, 3, 9, -4, 3, 12, 3, 0, 5, -4, 8};
+        ColumnarKeys<int> columns(keys);
+        CHECK(columns.size() == keys.size());
+        CHECK(columns.find(3) == 1);
+        CHECK(columns.find(8) == 10);
+        CHECK(columns.find(100) == keys.size());
+        CHECK(columns.count(3) == 3);
+        CHECK(columns.count(-4) == 2);
+        CHECK(columns.count(100) == 0);
+        CHECK(columns.min() == -4);
+        CHECK(columns.max() == 12);
+
+        ColumnarKeys<int> single(std::vector<int>{42});
+        CHECK(single.min() == 42);
+        CHECK(single.max() == 42);
+        CHECK(ColumnarKeys<int>(std::vector<int>()).find(1) == 0);
+    }
+
+    SUBCASE("double") {
+        std::vector<double> keys = {1.5, -2.25, 3.0, 1.5, 9.75};
+        ColumnarKeys<double> columns(keys);
+        CHECK(columns.find(1.5) == 0);
+        CHECK(columns.find(9.75) == 4);
+        CHECK(columns.find(3.0) == 2);
+        CHECK(columns.count(1.5) == 2);
+        CHECK(columns.min() == -2.25);
+        CHECK(columns.max() == 9.75);
+    }
+
+    SUBCASE("Complex") {
+        std::vector<Complex> keys = {Complex(1, 2), Complex(0, 5), Complex(3, 1), Complex(0, -1), Complex(3, 4), Complex(1, 2)};
+        ColumnarKeys<Complex> columns(keys);
+        CHECK(columns.find(Complex(3, 1)) == 2);
+        CHECK(columns.find(Complex(3, 2)) == keys.size());
+        CHECK(columns.count(Complex(1, 2)) == 2);
+        CHECK(columns.min() == Complex(0, -1));
+        CHECK(columns.max() == Complex(3, 4));
+    }
+
+    SUBCASE("Complex with NaN real parts") {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        for (std::size_t n = 1; n <= 5; ++n) {
+            std::vector<Complex> keys(n, Complex(nan, 7));
+            keys[n / 2] = Complex(nan, 2);
+            ColumnarKeys<Complex> columns(keys);
+            Complex least = columns.min();
+            Complex most = columns.max();
+            CHECK(std::isnan(least.get_real()));
+            CHECK(least.get_imag() == 2);
+            CHECK(std::isnan(most.get_real()));
+            CHECK(most.get_imag() == (n > 1 ? 7 : 2));
+        }
+        // The non-NaN key comes first and has the most extreme imaginary part, so a result
+        // that mixed its imaginary part into a NaN real part would show up here
+        std::size_t nan_results = 0;
+        for (std::size_t n = 1; n <= 5; ++n) {
+            std::vector<Complex> keys(n, Complex(nan, 5));
+            keys.insert(keys.begin(), Complex(1, -100));
+            Complex least = ColumnarKeys<Complex>(keys).min();
+            CHECK((std::isnan(least.get_real()) ? least.get_imag() == 5 : least == Complex(1, -100)));
+            keys.front() = Complex(1, 100);
+            Complex most = ColumnarKeys<Complex>(keys).max();
+            CHECK((std::isnan(most.get_real()) ? most.get_imag() == 5 : most == Complex(1, 100)));
+            nan_results += std::isnan(least.get_real()) + std::isnan(most.get_real());
+        }
+        CHECK(nan_results > 0);
+    }
+
+    SUBCASE("from a frozen tree") {
+        Tree<int> tree;
+        Node<int>& root = tree.emplace_root(10);
+        Node<int>* a = tree.emplace_sub_node(root, 20);
+        tree.emplace_sub_node(root, 15);
+        tree.emplace_sub_node(*a, 25);
+        FrozenTree<int> frozen = tree.freeze();
+        ColumnarKeys<int> columns = frozen.columns();
+        CHECK(frozen.key(columns.find(25)) == 25);
+        CHECK(columns.max() == 25);
+    }
+}
+
+/**
+ * @brief Test case for parallel subtree traversal.
+ */
+TEST_CASE("parallel for each") {
+    const int n = 5000;
+    Tree<int, 4> tree;
+    std::vector<Node<int>*> nodes;
+    std::vector<int> parent_of(n, -1);
+    nodes.push_back(&tree.emplace_root(0));
+    unsigned int state = 7;
+    for (int i = 1; i < n; ++i) {
+        Node<int>* parent = nullptr;
+        while (!parent) {
+            state = state * 1103515245u + 12345u;
+            int candidate = static_cast<int>((state >> 8) % static_cast<unsigned int>(i));
+            parent = tree.emplace_sub_node(*nodes[candidate], i);
+            if (parent) parent_of[i] = candidate;
+        }
+        nodes.push_back(parent);
+    }
+
+    WorkStealingPool pool(4);
+    std::vector<std::atomic<int> > visits(n);
+    std::vector<std::atomic<int> > stamp(n);
+    for (int i = 0; i < n; ++i) {
+        visits[i] = 0;
+        stamp[i] = 0;
+    }
+    std::atomic<int> clock(0);
+    auto record = [&](Node<int>& node) {
+        visits[node.get_key()].fetch_add(1);
+        stamp[node.get_key()] = clock.fetch_add(1);
+    };
+
+    SUBCASE("pre-order visits parents first") {
+        tree.parallel_for_each(Traversal::PreOrder, record, pool);
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(visits[i] == 1);
+            if (parent_of[i] >= 0) CHECK(stamp[parent_of[i]] < stamp[i]);
+        }
+    }
+
+    SUBCASE("post-order visits parents last") {
+        tree.parallel_for_each(Traversal::PostOrder, record, pool);
+        for (int i = 0; i < n; ++i) {
+            REQUIRE(visits[i] == 1);
+            if (parent_of[i] >= 0) CHECK(stamp[parent_of[i]] > stamp[i]);
+        }
+    }
+
+    SUBCASE("exceptions reach the caller") {
+        auto failing = [](Node<int>& node) {
+            if (node.get_key() == n / 2) throw std::runtime_error("boom");
+        };
+        CHECK_THROWS_AS(tree.parallel_for_each(Traversal::BFS, failing, pool), std::runtime_error);
+    }
+
+    SUBCASE("empty tree and shared pool") {
+        Tree<int> empty;
+        int calls = 0;
+        empty.parallel_for_each(Traversal::DFS, [&calls](Node<int>&) { ++calls; });
+        CHECK(calls == 0);
+
+        std::atomic<long long> sum(0);
+        tree.parallel_for_each(Traversal::DFS, [&sum](Node<int>& node) { sum += node.get_key(); });
+        CHECK(sum == static_cast<long long>(n) * (n - 1) / 2);
+    }
+}
+
+/**
+ * @brief Test case for parallel reductions.
+ */
+TEST_CASE("parallel reduce") {
+    const int n = 20000;
+    Tree<double, 3> tree;
+    std::vector<Node<double>*> nodes;
+    nodes.push_back(&tree.emplace_root(0.1));
+    for (int i = 1; i < n; ++i) {
+        double key = 1.0 / (i + 3) + (i % 7) * 1e-9;
+        nodes.push_back(tree.emplace_sub_node(*nodes[(i - 1) / 3], key));
+    }
+
+    WorkStealingPool one(1);
+    WorkStealingPool three(3);
+    WorkStealingPool eight(8);
+    auto plus = [](double a, double b) { return a + b; };
+
+    SUBCASE("double sums are deterministic") {
+        double sequential = 0;
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) sequential += it->get_key();
+
+        double a = tree.reduce(0.0, plus, one);
+        double b = tree.reduce(0.0, plus, three);
+        double c = tree.reduce(0.0, plus, eight);
+        double d = tree.reduce(0.0, plus, eight);
+        CHECK(a == b);
+        CHECK(b == c);
+        CHECK(c == d);
+        CHECK(a == doctest::Approx(sequential));
+    }
+
+    SUBCASE("min, max and count") {
+        auto smaller = [](double a, double b) { return b < a ? b : a; };
+        auto larger = [](double a, double b) { return a < b ? b : a; };
+        double root_key = tree.begin_bfs()->get_key();
+        CHECK(tree.reduce(root_key, smaller, three) == doctest::Approx(1.0 / (n - 1 + 3)).epsilon(1e-6));
+        CHECK(tree.reduce(root_key, larger, three) == doctest::Approx(1.0 / 4 + 1e-9));
+        CHECK(tree.count_if([](double key) { return key > 0.01; }, three) == 98);
+        CHECK(Tree<double>().count_if([](double) { return true; }) == 0);
+    }
+
+    SUBCASE("non-commutative operations keep pre-order") {
+        Tree<std::string, 3> words;
+        Node<std::string>& root = words.emplace_root("a");
+        Node<std::string>* b = words.emplace_sub_node(root, "b");
+        words.emplace_sub_node(root, "c");
+        words.emplace_sub_node(root, "d");
+        words.emplace_sub_node(*b, "e");
+        words.emplace_sub_node(*b, "f");
+        auto concat = [](const std::string& x, const std::string& y) { return x + y; };
+        CHECK(words.reduce(std::string(">"), concat, eight) == ">abefcd");
+    }
+
+    SUBCASE("Complex sums are deterministic") {
+        Tree<Complex, 2> complex_tree;
+        std::vector<Node<Complex>*> complex_nodes;
+        complex_nodes.push_back(&complex_tree.emplace_root(Complex(0.5, -0.5)));
+        for (int i = 1; i < 5000; ++i) {
+            complex_nodes.push_back(complex_tree.emplace_sub_node(*complex_nodes[(i - 1) / 2], Complex(1.0 / i, -1.0 / (i + 1))));
+        }
+        auto add = [](const Complex& x, const Complex& y) {
+            return Complex(x.get_real() + y.get_real(), x.get_imag() + y.get_imag());
+        };
+        Complex a = complex_tree.reduce(Complex(), add, one);
+        Complex b = complex_tree.reduce(Complex(), add, eight);
+        CHECK(a == b);
+    }
+}
+
+/**
+ * @brief Test case for bulk construction from parent arrays and edge lists.
+ */
+TEST_CASE("bulk build") {
+    std::vector<int> keys = {10, 20, 15, 25, 30, 35};
+
+    SUBCASE("parent array") {
+        Tree<int, 3> tree;
+        std::vector<int> parents = {-1, 0, 0, 1, 1, 2};
+        Node<int>& root = tree.build_from_parents(keys, parents);
+        CHECK(root.get_key() == 10);
+
+        std::vector<int> result;
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 20, 25, 30, 15, 35});
+    }
+
+    SUBCASE("root need not come first") {
+        SiblingTree<int, 2> tree;
+        std::vector<long> parents = {3, 3, 0, -1, 0, 1};
+        tree.build_from_parents(keys, parents);
+        std::vector<int> result;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{25, 10, 20, 15, 30, 35});
+    }
+
+    SUBCASE("edge list keeps edge order") {
+        InlineTree<int, 2> tree;
+        std::vector<std::pair<int, int> > edges = {{0, 2}, {0, 1}, {1, 3}, {2, 5}, {1, 4}};
+        tree.build_from_edges(keys, edges);
+        std::vector<int> result;
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{10, 15, 35, 20, 25, 30});
+    }
+
+    SUBCASE("invalid input") {
+        Tree<int, 2> tree;
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{-1, 0, 0, 0, 1, 2}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{-1, -1, 0, 1, 1, 2}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{1, 0, 0, 1, 1, 2}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{-1, 2, 1, 1, 0, 2}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{-1, 0, 9, 1, 1, 2}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_parents(keys, std::vector<int>{-1, 0}), std::invalid_argument);
+        CHECK_THROWS_AS(tree.build_from_edges(keys, std::vector<std::pair<int, int> >{{0, 1}, {0, 2}, {1, 3}, {2, 3}, {1, 4}}), std::invalid_argument);
+        CHECK_FALSE(tree.begin_bfs() != tree.end_bfs());
+    }
+
+    SUBCASE("key index is rebuilt") {
+        Tree<int, 3> tree;
+        tree.enable_key_index();
+        tree.build_from_parents(keys, std::vector<int>{-1, 0, 0, 1, 1, 2});
+        Node<int> parent(35);
+        Node<int> child(40);
+        tree.add_sub_node(parent, child);
+        int count = 0;
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) ++count;
+        CHECK(count == 7);
+    }
+}
+
+/**
+ * @brief Test case for building from a pre-order stream with child counts.
+ */
+TEST_CASE("pre-order build") {
+    SUBCASE("round trip through PreOrderIterator") {
+        Tree<int, 3> source;
+        source.build_from_parents(std::vector<int>{1, 2, 3, 4, 5, 6, 7}, std::vector<int>{-1, 0, 0, 0, 1, 1, 3});
+        std::vector<std::pair<int, std::size_t> > stream;
+        for (auto it = source.begin_pre_order(); it != source.end_pre_order(); ++it) {
+            stream.push_back(std::make_pair(it->get_key(), it->children.size()));
+        }
+
+        Tree<int, 3> tree;
+        tree.build_from_pre_order(stream.begin(), stream.end());
+        std::vector<int> expected, result;
+        for (auto it = source.begin_bfs(); it != source.end_bfs(); ++it) expected.push_back(it->get_key());
+        for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) result.push_back(it->get_key());
+        CHECK(result == expected);
+    }
+
+    SUBCASE("incremental pushes") {
+        SiblingTree<int, 2> tree;
+        SiblingTree<int, 2>::PreOrderBuilder builder(tree);
+        builder.push(1, 2);
+        builder.push(2, 0);
+        CHECK_FALSE(builder.complete());
+        CHECK_THROWS_AS(builder.finish(), std::invalid_argument);
+        CHECK_FALSE(tree.begin_dfs() != tree.end_dfs());
+        builder.push(3, 0);
+        CHECK(builder.complete());
+        CHECK(builder.finish().get_key() == 1);
+        int seen = 0;
+        for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) ++seen;
+        CHECK(seen == 3);
+        CHECK_THROWS_AS(builder.push(4, 0), std::invalid_argument);
+    }
+
+    SUBCASE("stream input") {
+        std::istringstream in("1 2  2 0  3 1  4 0\n10 0");
+        Tree<int, 2> tree;
+        tree.enable_key_index();
+        tree.read_pre_order(in);
+        std::vector<int> result;
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{2, 4, 3, 1});
+
+        Node<int> parent(4);
+        Node<int> child(5);
+        tree.add_sub_node(parent, child);
+        result.clear();
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) result.push_back(it->get_key());
+        CHECK(result == std::vector<int>{2, 5, 4, 3, 1});
+
+        Tree<int, 2> next;
+        CHECK(next.read_pre_order(in).get_key() == 10);
+    }
+
+    SUBCASE("invalid input") {
+        Tree<int, 2> tree;
+        std::istringstream truncated("1 2 2 0");
+        CHECK_THROWS_AS(tree.read_pre_order(truncated), std::invalid_argument);
+        std::istringstream malformed("1 x");
+        CHECK_THROWS_AS(tree.read_pre_order(malformed), std::invalid_argument);
+        std::istringstream too_wide("1 3 2 0 3 0 4 0");
+        CHECK_THROWS_AS(tree.read_pre_order(too_wide), std::invalid_argument);
+    }
+
+    SUBCASE("failed builds leave the tree unchanged") {
+        Tree<int, 2> tree;
+        tree.enable_key_index();
+        std::istringstream good("7 1 8 0");
+        Node<int>& root = tree.read_pre_order(good);
+        std::istringstream truncated("1 2 2 0");
+        CHECK_THROWS_AS(tree.read_pre_order(truncated), std::invalid_argument);
+        std::vector<std::pair<int, int> > wide{{1, 1}, {2, 3}};
+        CHECK_THROWS_AS(tree.build_from_pre_order(wide.begin(), wide.end()), std::invalid_argument);
+        CHECK(&*tree.begin_bfs() == &root);
+
+        // The key index holds none of the discarded nodes
+        Node<int> parent(2), child(3);
+        CHECK(tree.add_sub_node(parent, child) == nullptr);
+        Node<int> kept(8), grandchild(9);
+        CHECK(tree.add_sub_node(kept, grandchild) == root.children[0]);
+    }
+
+    SUBCASE("deep chain") {
+        const int depth = 200000;
+        std::vector<std::pair<int, int> > stream;
+        for (int i = 0; i < depth; ++i) stream.push_back(std::make_pair(i, i + 1 < depth ? 1 : 0));
+        Tree<int, 2> tree;
+        tree.build_from_pre_order(stream.begin(), stream.end());
+        int count = 0;
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) ++count;
+        CHECK(count == depth);
+    }
+}
+
+/**
+ * @brief Test case for the binary tree file format and memory-mapped loading.
+ */
+TEST_CASE("tree files") {
+    const std::string path = "test_tree_file.bin";
+
+    SUBCASE("round trip") {
+        Tree<int, 3> tree;
+        tree.build_from_parents(std::vector<int>{5, 3, 8, 1, 4, 7, 9}, std::vector<int>{-1, 0, 0, 1, 1, 2, 0});
+        FrozenTree<int> frozen = tree.freeze();
+        save_tree_file(path, frozen);
+
+        MappedTree<int> mapped(path);
+        CHECK(mapped.size() == 7);
+        CHECK(mapped.max_children() == 3);
+        CHECK(mapped.validate());
+        for (std::size_t i = 0; i < mapped.size(); ++i) {
+            CHECK(mapped.key(i) == frozen.key(i));
+            CHECK(mapped.child_count(i) == frozen.child_count(i));
+        }
+        std::vector<Traversal> orders = {Traversal::BFS, Traversal::PreOrder, Traversal::InOrder,
+                                         Traversal::PostOrder, Traversal::MinHeap};
+        for (Traversal order : orders) {
+            std::vector<int> expected, result;
+            frozen.for_each(order, [&expected](const int& key) { expected.push_back(key); });
+            mapped.for_each(order, [&result](const int& key) { result.push_back(key); });
+            CHECK(result == expected);
+        }
+
+        MappedTree<int> moved(std::move(mapped));
+        CHECK(moved.size() == 7);
+        CHECK(mapped.empty());
+    }
+
+    SUBCASE("complex keys and empty trees") {
+        Tree<Complex, 2> tree;
+        tree.build_from_parents(std::vector<Complex>{Complex(1, 2), Complex(3, -1), Complex(0.5, 0)},
+                                std::vector<int>{-1, 0, 0});
+        save_tree_file(path, tree.freeze());
+        MappedTree<Complex> mapped(path);
+        CHECK(mapped.key(1) == Complex(3, -1));
+        CHECK(mapped.validate());
+
+        save_tree_file(path, Tree<Complex, 2>().freeze());
+        MappedTree<Complex> empty(path);
+        CHECK(empty.empty());
+        CHECK(empty.validate());
+        int visited = 0;
+        empty.for_each(Traversal::BFS, [&visited](const Complex&) { ++visited; });
+        CHECK(visited == 0);
+    }
+
+    SUBCASE("rejected files") {
+        Tree<int, 2> tree;
+        tree.build_from_parents(std::vector<int>{1, 2, 3}, std::vector<int>{-1, 0, 0});
+        save_tree_file(path, tree.freeze());
+        CHECK_THROWS_AS(MappedTree<double>{path}, std::runtime_error);
+        CHECK_THROWS_AS(MappedTree<int>{"missing_tree_file.bin"}, std::runtime_error);
+
+        std::string bytes;
+        {
+            std::ifstream in(path.c_str(), std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        {
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), bytes.size() - 4);
+        }
+        CHECK_THROWS_AS(MappedTree<int>{path}, std::runtime_error);
+        {
+            std::string corrupt = bytes;
+            corrupt[0] = 'X';
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out.write(corrupt.data(), corrupt.size());
+        }
+        CHECK_THROWS_AS(MappedTree<int>{path}, std::runtime_error);
+        {
+            std::string corrupt = bytes;
+            std::uint32_t bad = 7;
+            std::memcpy(&corrupt[corrupt.size() - 8], &bad, sizeof(bad));
+            std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+            out.write(corrupt.data(), corrupt.size());
+        }
+        CHECK_FALSE(MappedTree<int>(path).validate());
+    }
+
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief Test case for the iterative text serializer and its parse-back counterpart.
+ */
+TEST_CASE("text round trip") {
+    SUBCASE("format") {
+        Tree<int, 3> tree;
+        tree.build_from_parents(std::vector<int>{1, 2, 3, 4, 5}, std::vector<int>{-1, 0, 0, 1, 1});
+        std::ostringstream out;
+        out << tree;
+        CHECK(out.str() == "1\n  2\n    4\n    5\n  3\n");
+
+        std::istringstream in(out.str());
+        Tree<int, 3> parsed;
+        CHECK(parsed.read_text(in).get_key() == 1);
+        std::ostringstream again;
+        again << parsed;
+        CHECK(again.str() == out.str());
+    }
+
+    SUBCASE("complex keys") {
+        Tree<Complex, 2> tree;
+        tree.build_from_parents(std::vector<Complex>{Complex(1, 2), Complex(-0.5, -3), Complex(4, 0)},
+                                std::vector<int>{-1, 0, 0});
+        std::ostringstream out;
+        out << tree;
+        CHECK(out.str() == "1+2i\n  -0.5+-3i\n  4+0i\n");
+        std::istringstream in(out.str());
+        Tree<Complex, 2> parsed;
+        parsed.read_text(in);
+        std::vector<Complex> keys;
+        for (auto it = parsed.begin_bfs(); it != parsed.end_bfs(); ++it) keys.push_back(it->get_key());
+        CHECK(keys == std::vector<Complex>{Complex(1, 2), Complex(-0.5, -3), Complex(4, 0)});
+    }
+
+    SUBCASE("string keys with spaces") {
+        Tree<std::string, 2> tree;
+        tree.build_from_parents(std::vector<std::string>{"root node", "a b c", "tail  "}, std::vector<int>{-1, 0, 0});
+        std::ostringstream out;
+        out << tree;
+        std::istringstream in(out.str());
+        Tree<std::string, 2> parsed;
+        CHECK(parsed.read_text(in).get_key() == "root node");
+        std::vector<std::string> keys;
+        for (auto it = parsed.begin_bfs(); it != parsed.end_bfs(); ++it) keys.push_back(it->get_key());
+        CHECK(keys == std::vector<std::string>{"root node", "a b c", "tail  "});
+    }
+
+    SUBCASE("deep chain") {
+        const int depth = 3000;
+        std::vector<int> keys(depth), parents(depth);
+        for (int i = 0; i < depth; ++i) {
+            keys[i] = i;
+            parents[i] = i - 1;
+        }
+        Tree<int, 1> tree;
+        tree.build_from_parents(keys, parents);
+        std::stringstream text;
+        text << tree;
+        Tree<int, 1> parsed;
+        parsed.read_text(text);
+        int count = 0;
+        bool in_order = true;
+        for (auto it = parsed.begin_pre_order(); it != parsed.end_pre_order(); ++it, ++count) {
+            in_order = in_order && it->get_key() == count;
+        }
+        CHECK(in_order);
+        CHECK(count == depth);
+    }
+
+    SUBCASE("invalid text") {
+        Tree<int, 2> tree;
+        std::istringstream empty("\n\n");
+        CHECK_THROWS_AS(tree.read_text(empty), std::invalid_argument);
+        std::istringstream skipped("1\n    2\n");
+        CHECK_THROWS_AS(tree.read_text(skipped), std::invalid_argument);
+        std::istringstream odd("1\n 2\n");
+        CHECK_THROWS_AS(tree.read_text(odd), std::invalid_argument);
+        std::istringstream two_roots("1\n2\n");
+        CHECK_THROWS_AS(tree.read_text(two_roots), std::invalid_argument);
+        std::istringstream bad_key("1\n  x\n");
+        CHECK_THROWS_AS(tree.read_text(bad_key), std::invalid_argument);
+        std::istringstream too_wide("1\n  2\n  3\n  4\n");
+        CHECK_THROWS_AS(tree.read_text(too_wide), std::invalid_argument);
+    }
+
+    SUBCASE("failed reads leave the tree unchanged") {
+        Tree<int, 2> tree;
+        tree.enable_key_index();
+        std::istringstream good("7\n  8\n");
+        Node<int>& root = tree.read_text(good);
+        std::istringstream bad_key("1\n  2\n  x\n");
+        CHECK_THROWS_AS(tree.read_text(bad_key), std::invalid_argument);
+        std::istringstream two_roots("3\n4\n");
+        CHECK_THROWS_AS(tree.read_text(two_roots), std::invalid_argument);
+        CHECK(&*tree.begin_bfs() == &root);
+        Node<int> parent(2), child(5);
+        CHECK(tree.add_sub_node(parent, child) == nullptr);
+    }
+}
+
+/**
+ * @brief A key type without a format_key overload, printed through operator<<.
+ */
+struct Tagged {
+    int value;
+    friend std::ostream& operator<<(std::ostream& os, const Tagged& t) {
+        return os << "tagged key with a long description #" << t.value;
+    }
+};
+
+/**
+ * @brief Test case for allocation-free key formatting.
+ */
+TEST_CASE("key formatting") {
+    char buffer[64];
+
+    SUBCASE("matches operator<<") {
+        std::vector<long long> integers = {0, 7, -7, 42, 2147483647LL, -2147483647LL - 1,
+                                           9223372036854775807LL, -9223372036854775807LL - 1};
+        for (long long value : integers) {
+            std::ostringstream expected;
+            expected << value;
+            char* end = format_key(buffer, buffer + sizeof(buffer), value);
+            REQUIRE(end != nullptr);
+            CHECK(std::string(buffer, end) == expected.str());
+        }
+        std::vector<double> reals = {0.0, -0.0, 1.5, -2.25, 0.1, 1e20, 123456789.0, 1e-7};
+        for (double value : reals) {
+            std::ostringstream expected;
+            expected << value;
+            char* end = format_key(buffer, buffer + sizeof(buffer), value);
+            REQUIRE(end != nullptr);
+            CHECK(std::string(buffer, end) == expected.str());
+        }
+
+        std::string text;
+        append_key(text, 18446744073709551615ULL);
+        append_key(text, ' ');
+        append_key(text, true);
+        append_key(text, 2.5f);
+        append_key(text, std::string("|key|"));
+        append_key(text, Complex(1.5, -2));
+        CHECK(text == "18446744073709551615 12.5|key|1.5+-2i");
+    }
+
+    SUBCASE("too small buffers") {
+        CHECK(format_key(buffer, buffer + 2, 123) == nullptr);
+        CHECK(format_key(buffer, buffer + 3, -12) != nullptr);
+        CHECK(format_key(buffer, buffer + 3, -123) == nullptr);
+        CHECK(format_key(buffer, buffer + 4, Complex(1, 2)) != nullptr);
+        CHECK(format_key(buffer, buffer + 3, Complex(1, 2)) == nullptr);
+        CHECK(format_key(buffer, buffer + 5, Tagged{1}) == nullptr);
+    }
+
+    SUBCASE("fallback grows the string") {
+        std::string text = "> ";
+        append_key(text, Tagged{12});
+        CHECK(text == "> tagged key with a long description #12");
+    }
+
+    SUBCASE("toString") {
+        CHECK(Node<int>(-15).toString() == "-15");
+        CHECK(Node<double>(0.25).toString() == "0.25");
+        CHECK(Node<Complex>(Complex(3, 4)).toString() == "3+4i");
+        CHECK(Complex(3, 4).toString() == "3+4i");
+        CHECK(Node<Tagged>(Tagged{5}).toString() == "tagged key with a long description #5");
+    }
+}
+
+/**
+ * @brief Compute a subtree width the way the original recursive demo code did.
+ */
+static int reference_width(Node<int>* node) {
+    int width = 0;
+    for (auto child : node->children) width += reference_width(child);
+    return std::max(width, 1);
+}
+
+/**
+ * @brief Compute node positions in pre-order the way the original recursive demo code did.
+ */
+static void reference_positions(Node<int>* node, float x, float y, std::vector<std::pair<float, float> >& out) {
+    out.push_back(std::make_pair(x, y));
+    float child_x = x - reference_width(node) * 100.0f / 2 + 100.0f / 2;
+    for (auto child : node->children) {
+        reference_positions(child, child_x, y + 80.0f, out);
+        child_x += reference_width(child) * 100.0f;
+    }
+}
+
+/**
+ * @brief Test case for the cached tree layout.
+ */
+TEST_CASE("tree layout") {
+    std::vector<int> keys = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<int> parents = {-1, 0, 0, 0, 1, 1, 3, 6, 6};
+    Tree<int, 3> tree;
+    Node<int>& root = tree.build_from_parents(keys, parents);
+
+    auto check_against_reference = [&root](TreeLayout<Node<int> >& layout) {
+        std::vector<std::pair<float, float> > expected;
+        reference_positions(&root, 500, 50, expected);
+        std::vector<std::pair<float, float> > actual;
+        for (auto it = Tree<int, 3>::PreOrderIterator(&root); it != Tree<int, 3>::PreOrderIterator(nullptr); ++it) {
+            TreeLayout<Node<int> >::Point p = layout.position(*it);
+            actual.push_back(std::make_pair(p.x, p.y));
+        }
+        CHECK(actual == expected);
+    };
+
+    SUBCASE("full build") {
+        TreeLayout<Node<int> > layout(100, 80);
+        layout.build(&root, 500, 50);
+        CHECK(layout.size() == 9);
+        CHECK(layout.width(root) == 5);
+        check_against_reference(layout);
+
+        int visited = 0;
+        layout.for_each([&visited](Node<int>&, const TreeLayout<Node<int> >::Point& p,
+                                   const TreeLayout<Node<int> >::Point& parent) {
+            CHECK((visited == 0 ? p.y == parent.y : p.y == parent.y + 80));
+            ++visited;
+        });
+        CHECK(visited == 9);
+    }
+
+    SUBCASE("incremental attach") {
+        TreeLayout<Node<int> > layout(100, 80);
+        layout.build(&root, 500, 50);
+        std::size_t version = layout.version();
+
+        Node<int> leaf_child(10), subtree_root(11), subtree_leaf(12);
+        subtree_root.add_child(&subtree_leaf);
+        Node<int> leaf_parent(4);
+        Node<int>* attached = tree.add_sub_node(leaf_parent, leaf_child);
+        REQUIRE(attached != nullptr);
+        layout.attach(*attached, leaf_child);
+        CHECK(layout.width(root) == 5);
+
+        Node<int> inner_parent(2);
+        attached = tree.add_sub_node(inner_parent, subtree_root);
+        REQUIRE(attached != nullptr);
+        layout.attach(*attached, subtree_root);
+        CHECK(layout.width(root) == 5);
+
+        Node<int> wide_parent(1);
+        Node<int> extra(13);
+        layout.attach(*tree.add_sub_node(wide_parent, extra), extra);
+        CHECK(layout.width(root) == 6);
+        CHECK(layout.size() == 13);
+        CHECK(layout.version() != version);
+        check_against_reference(layout);
+
+        TreeLayout<Node<int> > rebuilt(100, 80);
+        rebuilt.build(&root, 500, 50);
+        CHECK(rebuilt.width(root) == layout.width(root));
+
+        Node<int> stranger(99);
+        CHECK_THROWS_AS(layout.attach(stranger, extra), std::invalid_argument);
+        CHECK(tree.add_sub_node(stranger, extra) == nullptr);
+    }
+}
+
+/**
+ * @brief Test case for the batched tree geometry.
+ */
+TEST_CASE("tree geometry") {
+    Tree<int, 2> tree;
+    Node<int>& root = tree.build_from_parents(std::vector<int>{7, 12, 3}, std::vector<int>{-1, 0, 0});
+    TreeLayout<Node<int> > layout(100, 100);
+    layout.build(&root, 500, 50);
+
+    TreeGeometry<Node<int> >::Style style = {40, 14, {255, 255, 255, 255}, {0, 0, 0, 255}, {255, 255, 255, 255}};
+    TreeGeometry<Node<int> > geometry(style);
+    int glyph_calls = 0;
+    auto glyph = [&glyph_calls](unsigned char c) {
+        ++glyph_calls;
+        GlyphMetrics m = {8, 1, -10, 6, 10, static_cast<float>(c) * 8, 0, 6, 10};
+        return m;
+    };
+
+    CHECK(geometry.update(layout, glyph));
+    CHECK(geometry.edges().size() == 4);
+    CHECK(geometry.discs().size() == 3 * 6);
+    CHECK(geometry.discs()[2].u == doctest::Approx(80));
+    CHECK(geometry.labels().size() == 6 * 4);
+    CHECK(glyph_calls == 4);
+
+    const GeometryVertex& first = geometry.labels()[0];
+    CHECK(first.x == doctest::Approx(500 - 20 + 1));
+    CHECK(first.y == doctest::Approx(50 - 20 + 14 - 10));
+    CHECK(first.u == doctest::Approx('7' * 8));
+    CHECK(geometry.edges()[1].x == doctest::Approx(450));
+    CHECK(geometry.edges()[1].y == doctest::Approx(150));
+
+    CHECK_FALSE(geometry.update(layout, glyph));
+    CHECK(geometry.rebuild_count() == 1);
+
+    Node<int> parent(3), child(30);
+    layout.attach(*tree.add_sub_node(parent, child), child);
+    CHECK(geometry.update(layout, glyph));
+    CHECK(geometry.edges().size() == 6);
+    CHECK(geometry.labels().size() == 6 * 6);
+    CHECK(glyph_calls == 5);
+}
+
+/**
+ * @brief Test case for viewport queries and level of detail.
+ */
+TEST_CASE("viewport culling") {
+    std::vector<int> keys, parents;
+    for (int i = 0; i < 1365; ++i) {
+        keys.push_back(i);
+        parents.push_back(i == 0 ? -1 : (i - 1) / 4);
+    }
+    Tree<int, 4> tree;
+    Node<int>& root = tree.build_from_parents(keys, parents);
+    TreeLayout<Node<int> > layout(100, 100);
+    layout.build(&root, 0, 0);
+
+    typedef TreeLayout<Node<int> >::Point Point;
+    typedef TreeLayout<Node<int> >::Box Box;
+    auto ignore = [](Node<int>&, const Box&, const Point&) { FAIL("nothing should collapse"); };
+
+    SUBCASE("a small view reports every node inside it and few others") {
+        Box view = {-2000, 150, -1000, 450};
+        std::vector<bool> seen(keys.size(), false);
+        std::size_t reported = 0;
+        bool parents_first = true;
+        layout.for_each_in(view, 40, 0, [&](Node<int>& node, const Point&, const Point&) {
+            int key = node.get_key();
+            if (key != 0 && !seen[static_cast<std::size_t>((key - 1) / 4)]) parents_first = false;
+            seen[static_cast<std::size_t>(key)] = true;
+            ++reported;
+        }, ignore);
+        CHECK(parents_first);
+        std::size_t inside = 0;
+        layout.for_each([&](Node<int>& node, const Point& p, const Point&) {
+            if (p.x + 40 >= view.left && p.x - 40 <= view.right && p.y + 40 >= view.top && p.y - 40 <= view.bottom) {
+                CHECK(seen[static_cast<std::size_t>(node.get_key())]);
+                ++inside;
+            }
+        });
+        CHECK(inside > 0);
+        CHECK(reported < inside + 40);
+    }
+
+    SUBCASE("an attached subtree is found by later queries") {
+        Node<int> extra(5000);
+        Node<int>* parent = tree.add_sub_node(*root.children[0]->children[0]->children[0]->children[0]->children[0], extra);
+        REQUIRE(parent != nullptr);
+        layout.attach(*parent, extra);
+        Point p = layout.position(extra);
+        Box view = {p.x - 1, p.y - 1, p.x + 1, p.y + 1};
+        bool found = false;
+        layout.for_each_in(view, 0, 0, [&](Node<int>& node, const Point&, const Point&) {
+            if (&node == &extra) found = true;
+        }, ignore);
+        CHECK(found);
+    }
+
+    SUBCASE("subtrees below the minimum extent collapse") {
+        Box view = {-1e6f, -1e6f, 1e6f, 1e6f};
+        std::size_t visible = 0, collapsed = 0;
+        layout.for_each_in(view, 40, 1e6f, [&](Node<int>&, const Point&, const Point&) { ++visible; },
+            [&](Node<int>& node, const Box& box, const Point&) {
+                CHECK(&node == &root);
+                CHECK(box.right - box.left == doctest::Approx(1024 * 100 - 100 + 80));
+                ++collapsed;
+            });
+        CHECK(visible == 0);
+        CHECK(collapsed == 1);
+
+        visible = collapsed = 0;
+        layout.for_each_in(view, 40, 350, [&](Node<int>&, const Point&, const Point&) { ++visible; },
+            [&](Node<int>&, const Box&, const Point&) { ++collapsed; });
+        CHECK(visible == 1 + 4 + 16 + 64);
+        CHECK(collapsed == 256);
+    }
+
+    SUBCASE("the geometry follows the viewport") {
+        TreeGeometry<Node<int> >::Style style = {40, 14, {255, 255, 255, 255}, {0, 0, 0, 255}, {255, 255, 255, 255}};
+        TreeGeometry<Node<int> > geometry(style);
+        auto glyph = [](unsigned char c) {
+            GlyphMetrics m = {8, 1, -10, 6, 10, static_cast<float>(c) * 8, 0, 6, 10};
+            return m;
+        };
+        TreeGeometry<Node<int> >::Viewport near = {{-500, -50, 500, 550}, 1};
+        CHECK(geometry.update(layout, near, glyph));
+        CHECK_FALSE(geometry.update(layout, near, glyph));
+        CHECK(geometry.aggregate_count() == 0);
+        CHECK(geometry.discs().size() < 6 * 100);
+        CHECK_FALSE(geometry.labels().empty());
+
+        TreeGeometry<Node<int> >::Viewport far = {{-200000, -1000, 200000, 60000}, 0.002f};
+        CHECK(geometry.update(layout, far, glyph));
+        CHECK(geometry.aggregate_count() == 256);
+        CHECK(geometry.labels().empty());
+        CHECK(geometry.discs().size() == 6 * (1 + 4 + 16 + 64 + 256));
+        CHECK(geometry.edges().size() == 2 * (4 + 16 + 64 + 256));
+    }
+}
+
+/**
+ * @brief Test case for headless SVG rendering.
+ */
+TEST_CASE("svg rendering") {
+    Tree<std::string, 4> tree;
+    std::istringstream in("c\n  a<&\n    d\n    e\n  b\n    f\n");
+    Node<std::string>& root = tree.read_text(in);
+    TreeLayout<Node<std::string> > layout(100, 100);
+    layout.build(&root, 500, 50);
+    SvgStyle style = {40, 14, "blue", "white", "black", "white"};
+
+    std::ostringstream out;
+    write_svg(out, layout, style);
+    std::string svg = out.str();
+    auto count = [&svg](const std::string& what) {
+        std::size_t found = 0;
+        for (std::size_t at = svg.find(what); at != std::string::npos; at = svg.find(what, at + 1)) ++found;
+        return found;
+    };
+
+    CHECK(svg.find("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"310 10 330 280\"") == 0);
+    CHECK(svg.find("fill=\"blue\"") != std::string::npos);
+    CHECK(count("<circle") == 6);
+    CHECK(count("<text") == 6);
+    CHECK(count("L") == 5);
+    CHECK(svg.find("<circle cx=\"350\" cy=\"250\" r=\"40\"/>") != std::string::npos);
+    CHECK(svg.find(">a&lt;&amp;</text>") != std::string::npos);
+    CHECK(svg.find("<text x=\"480\" y=\"44\">c</text>") != std::string::npos);
+    CHECK(svg.substr(svg.size() - 7) == "</svg>\n");
+
+    SUBCASE("coordinates keep one decimal") {
+        TreeLayout<Node<std::string> > shifted(100, 100);
+        shifted.build(&root, -0.25f, 12.5f);
+        std::ostringstream text;
+        style.background = nullptr;
+        write_svg(text, shifted, style);
+        CHECK(text.str().find("<rect") == std::string::npos);
+        CHECK(text.str().find("<circle cx=\"-0.3\" cy=\"12.5\"") != std::string::npos);
+    }
+
+    SUBCASE("non-finite and huge coordinates are rejected") {
+        TreeLayout<Node<std::string> > broken(100, 100);
+        broken.build(&root, std::numeric_limits<float>::quiet_NaN(), 0);
+        std::ostringstream text;
+        CHECK_THROWS_AS(write_svg(text, broken, style), std::invalid_argument);
+        broken.set_origin(std::numeric_limits<float>::infinity(), 0);
+        CHECK_THROWS_AS(write_svg(text, broken, style), std::invalid_argument);
+        broken.set_origin(1e30f, 0);
+        CHECK_THROWS_AS(write_svg(text, broken, style), std::invalid_argument);
+    }
+}
+
+/**
+ * @brief Test case for the synthetic tree generator.
+ */
+TEST_CASE("tree generator") {
+    SUBCASE("the same spec gives the same tree") {
+        TreeSpec spec(5000, 99);
+        spec.duplicate_rate = 0.1;
+        CHECK(generate_parents(spec, 3) == generate_parents(spec, 3));
+        CHECK(generate_keys<int>(spec) == generate_keys<int>(spec));
+        TreeSpec other = spec;
+        other.seed = 100;
+        CHECK(generate_parents(spec, 3) != generate_parents(other, 3));
+        CHECK(generate_keys<int>(spec) != generate_keys<int>(other));
+    }
+
+    SUBCASE("shapes") {
+        std::vector<long> complete = generate_parents(TreeSpec::complete(1000, 3), 3);
+        REQUIRE(complete.size() == 1000);
+        bool level_order = true;
+        for (std::size_t i = 1; i < complete.size(); ++i) level_order &= complete[i] == static_cast<long>((i - 1) / 3);
+        CHECK(level_order);
+
+        Tree<int, 1000> star;
+        Node<int>& hub = generate_tree(star, TreeSpec::star(1000));
+        CHECK(hub.children.size() == 999);
+
+        for (Branching branching : {Branching::Uniform, Branching::Geometric, Branching::Attach}) {
+            TreeSpec spec(20000, 5);
+            spec.branching = branching;
+            spec.max_children = 4;
+            spec.mean_children = 2.5;
+            std::vector<long> parents = generate_parents(spec, 3);
+            std::vector<std::size_t> children(parents.size(), 0);
+            bool ordered = parents[0] == -1;
+            for (std::size_t i = 1; i < parents.size(); ++i) {
+                ordered &= parents[i] >= 0 && static_cast<std::size_t>(parents[i]) < i;
+                ++children[static_cast<std::size_t>(parents[i])];
+            }
+            CHECK(parents.size() == 20000);
+            CHECK(ordered);
+            CHECK(*std::max_element(children.begin(), children.end()) <= 3);
+        }
+    }
+
+    SUBCASE("depth limit") {
+        TreeSpec spec(7);
+        spec.max_depth = 2;
+        std::vector<long> parents = generate_parents(spec, 2);
+        std::sort(parents.begin(), parents.end());
+        CHECK(parents == std::vector<long>{-1, 0, 0, 1, 1, 2, 2});
+        spec.nodes = 8;
+        CHECK_THROWS_AS(generate_parents(spec, 2), std::invalid_argument);
+        spec.nodes = 0;
+        CHECK_THROWS_AS(generate_parents(spec, 2), std::invalid_argument);
+    }
+
+    SUBCASE("keys") {
+        TreeSpec spec(10000);
+        std::vector<int> keys = generate_keys<int>(spec);
+        std::vector<int> sorted = keys;
+        std::sort(sorted.begin(), sorted.end());
+        CHECK(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+        CHECK(sorted.front() == 0);
+        CHECK(sorted.back() == 9999);
+
+        spec.keys = KeyOrder::Descending;
+        CHECK(generate_keys<int>(spec).front() == 9999);
+
+        spec.keys = KeyOrder::Shuffled;
+        spec.duplicate_rate = 0.5;
+        sorted = generate_keys<int>(spec);
+        std::sort(sorted.begin(), sorted.end());
+        std::size_t distinct = static_cast<std::size_t>(std::unique(sorted.begin(), sorted.end()) - sorted.begin());
+        CHECK(distinct > 4000);
+        CHECK(distinct < 6000);
+
+        Tree<std::string, 2> named;
+        TreeSpec small(3);
+        small.keys = KeyOrder::Ascending;
+        CHECK(generate_tree(named, small).get_key() == "0");
+    }
+
+    SUBCASE("a million-deep chain") {
+        const std::size_t n = 1000000;
+        Tree<int, 1> chain;
+        Node<int>& root = generate_tree(chain, TreeSpec::chain(n));
+        Node<int>* node = &root;
+        std::size_t depth = 1;
+        while (!node->children.empty()) {
+            node = node->children[0];
+            ++depth;
+        }
+        CHECK(depth == n);
+
+        std::size_t counts[5] = {0, 0, 0, 0, 0};
+        for (auto it = chain.begin_bfs(); it != chain.end_bfs(); ++it) ++counts[0];
+        for (auto it = chain.begin_dfs(); it != chain.end_dfs(); ++it) ++counts[1];
+        for (auto it = chain.begin_in_order(); it != chain.end_in_order(); ++it) ++counts[2];
+        for (auto it = chain.begin_post_order(); it != chain.end_post_order(); ++it) ++counts[3];
+        for (auto it = chain.begin_pre_order(); it != chain.end_pre_order(); ++it) ++counts[4];
+        for (std::size_t count : counts) CHECK(count == n);
+
+        TreeLayout<Node<int> > layout(100, 100);
+        layout.build(&root, 0, 0);
+        CHECK(layout.extent(0).bottom == doctest::Approx((n - 1) * 100.0));
+    }
+}
+
+/**
+ * @brief Test case for the optional instrumentation counters.
+ */
+TEST_CASE("tree stats") {
+    Tree<int, 2> tree;
+    Node<int> root(1), a(2), b(3), c(4), missing(9), orphan(5);
+    tree.add_root(root);
+    tree.add_sub_node(root, a);
+    tree.add_sub_node(root, b);
+    CHECK(tree.add_sub_node(root, c) == nullptr);
+    CHECK(tree.add_sub_node(missing, orphan) == nullptr);
+    CHECK(tree.emplace_sub_node(root, 6) == nullptr);
+    for (auto it = tree.begin_bfs(); it != tree.end_bfs(); ++it) {}
+    for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) {}
+
+    std::ostringstream text, json;
+    tree.stats().write_text(text);
+    tree.stats().write_json(json);
+
+#ifdef TREE_STATS
+    const TreeStats& stats = tree.stats();
+    // The searches visit 1, 1, 1 and 3 nodes
+    CHECK(stats.find_visits() == 6);
+    CHECK(stats.insert_searches().count() == 4);
+    CHECK(stats.insert_searches().max() == 3);
+    CHECK(stats.insert_searches().bucket_count(StatsHistogram::bucket(1)) == 3);
+    CHECK(stats.failed_adds(AddFailure::MissingParent) == 1);
+    CHECK(stats.failed_adds(AddFailure::FullParent) == 2);
+    CHECK(stats.iterator_frontier(IteratorKind::BFS).count() == 1);
+    CHECK(stats.iterator_frontier(IteratorKind::BFS).max() == 2);
+    CHECK(stats.iterator_frontier(IteratorKind::PostOrder).max() == 2);
+    CHECK(stats.iterator_frontier(IteratorKind::DFS).count() == 0);
+    CHECK(text.str().find("find_node visits: 6\n") != std::string::npos);
+    CHECK(json.str().find("\"failed_adds\": {\"missing_parent\": 1, \"full_parent\": 2}") != std::string::npos);
+
+    // Internal walks are not recorded
+    tree.memory_usage();
+    CHECK(stats.iterator_frontier(IteratorKind::BFS).count() == 1);
+
+    // A traversal abandoned before its end is not recorded
+    auto it = tree.begin_dfs();
+    ++it;
+    CHECK(stats.iterator_frontier(IteratorKind::DFS).count() == 0);
+
+    tree.reset_stats();
+    CHECK(tree.stats().find_visits() == 0);
+#else
+    // Disabled, the probe adds nothing to the iterators
+    CHECK(sizeof(Tree<int>::BFSIterator) == sizeof(ScratchVector<Node<int>*>) + sizeof(std::size_t));
+    CHECK(sizeof(Tree<int>::DFSIterator) == sizeof(ScratchVector<Node<int>*>));
+    CHECK(sizeof(Tree<int>) == sizeof(Node<int>*) + 2 * sizeof(std::shared_ptr<int>));
+    CHECK(tree.stats().find_visits() == 0);
+    CHECK(json.str() == "{\"enabled\": false}");
+#endif
+}
+
+/**
+ * @brief Test case for walks over million-deep chains, which must not recurse.
+ */
+TEST_CASE("deep chains") {
+    const std::size_t n = 1000000;
+    TreeSpec spec = TreeSpec::chain(n);
+    spec.keys = KeyOrder::Descending;
+    Tree<int, 1> chain;
+    Node<int>& root = generate_tree(chain, spec);
+    Node<int>* leaf = &root;
+    while (!leaf->children.empty()) leaf = leaf->children[0];
+
+    SUBCASE("search and insert") {
+        Node<int> deepest(0), absent(-1), below(-2);
+        CHECK(chain.find_node(&root, deepest) == leaf);
+        CHECK(chain.find_node(&root, absent) == nullptr);
+        Tree<int, 1>::TraversalScratch scratch;
+        CHECK(chain.find_node(&root, deepest, scratch) == leaf);
+        CHECK(chain.find_node(&root, absent, scratch) == nullptr);
+#ifndef TREE_STATS
+        // Searches share no state, so several may run on one tree at once
+        Node<int>* found = nullptr;
+        std::thread other([&]() { found = chain.find_node(&root, deepest); });
+        CHECK(chain.find_node(&root, deepest) == leaf);
+        other.join();
+        CHECK(found == leaf);
+#endif
+        CHECK(chain.add_sub_node(deepest, below) == leaf);
+        CHECK(chain.add_sub_node(deepest, absent) == nullptr);
+        chain.enable_key_index();
+        CHECK(chain.add_sub_node(below, absent) == &below);
+    }
+
+    SUBCASE("ordered walks") {
+        std::size_t count = 0;
+        int previous = -1;
+        bool ascending = true;
+        for (auto it = chain.begin_min_heap(); it != chain.end_min_heap(); ++it, ++count) {
+            ascending = ascending && it->get_key() > previous;
+            previous = it->get_key();
+        }
+        CHECK(count == n);
+        CHECK(ascending);
+        CHECK(!chain.is_heap_ordered());
+        std::vector<Node<int>*> least = chain.smallest(3);
+        REQUIRE(least.size() == 3);
+        CHECK(least[2]->get_key() == 2);
+        CHECK(chain.memory_usage() >= n * sizeof(Node<int>));
+        CHECK(chain.count_if([](int key) { return key % 2 == 0; }) == n / 2);
+        CHECK(chain.freeze().size() == n);
+    }
+}
+
+/**
+ * @brief Test case for traversals that borrow a reusable scratch.
+ */
+TEST_CASE("traversal scratch") {
+    Tree<int, 3> tree;
+    generate_tree(tree, TreeSpec(2000, 7));
+    typedef Tree<int, 3> IntTree;
+    IntTree::TraversalScratch scratch;
+
+    auto keys = [](IntTree::BFSIterator it, IntTree::BFSIterator end) {
+        std::vector<int> out;
+        for (; it != end; ++it) out.push_back(it->get_key());
+        return out;
+    };
+
+    SUBCASE("same orders as without a scratch") {
+        for (int round = 0; round < 2; ++round) {
+            CHECK(keys(tree.begin_bfs(scratch), tree.end_bfs()) == keys(tree.begin_bfs(), tree.end_bfs()));
+            std::vector<int> plain, borrowed;
+            for (auto it = tree.begin_dfs(); it != tree.end_dfs(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_dfs(scratch); it != tree.end_dfs(); ++it) borrowed.push_back(it->get_key());
+            for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_in_order(scratch); it != tree.end_in_order(); ++it) borrowed.push_back(it->get_key());
+            for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_post_order(scratch); it != tree.end_post_order(); ++it) borrowed.push_back(it->get_key());
+            for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_pre_order(scratch); it != tree.end_pre_order(); ++it) borrowed.push_back(it->get_key());
+            for (auto it = tree.begin_min_heap(); it != tree.end_min_heap(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_min_heap(scratch); it != tree.end_min_heap(); ++it) borrowed.push_back(it->get_key());
+            for (auto it = tree.begin_frontier(); it != tree.end_frontier(); ++it) plain.push_back(it->get_key());
+            for (auto it = tree.begin_frontier(scratch); it != tree.end_frontier(); ++it) borrowed.push_back(it->get_key());
+            CHECK(borrowed == plain);
+        }
+    }
+
+    SUBCASE("storage is kept between traversals") {
+        tree.presize_scratch(scratch);
+        std::size_t capacity = scratch.capacity();
+        CHECK(capacity >= 2000);
+        for (auto it = tree.begin_min_heap(scratch); it != tree.end_min_heap(); ++it) {}
+        for (auto it = tree.begin_bfs(scratch); it != tree.end_bfs(); ++it) {}
+        for (auto it = tree.begin_frontier(scratch); it != tree.end_frontier(); ++it) {}
+        CHECK(scratch.capacity() == capacity);
+
+        // A traversal started while another holds the storage still works
+        auto outer = tree.begin_dfs(scratch);
+        CHECK(scratch.capacity() == 0);
+        std::size_t inner = 0;
+        for (auto it = tree.begin_dfs(scratch); it != tree.end_dfs(); ++it) ++inner;
+        CHECK(inner == 2000);
+        auto copy = outer;
+        ++copy;
+        CHECK(outer->get_key() == tree.begin_dfs()->get_key());
+    }
+    CHECK(scratch.capacity() > 0);
+}
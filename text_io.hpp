@@ -0,0 +1,211 @@
+/**
+ * @file text_io.hpp
+ * @brief Declaration of the BlockWriter and LineReader classes for buffered tree text I/O.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains two small helpers used by the tree text serializer. BlockWriter is a
+ * stream buffer that collects output in one large block and hands it to the target stream a
+ * block at a time, so formatting many short lines costs a memcpy per line instead of a trip
+ * through the target stream. LineReader reads an input stream in large blocks and returns it
+ * line by line without copying.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef TEXT_IO_HPP
+#define TEXT_IO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+/**
+ * @class BlockWriter
+ * @brief A stream buffer that writes to another stream in large blocks.
+ *
+ * Whatever is still buffered is flushed by sync(), flush(), and the destructor.
+ */
+class BlockWriter : public std::streambuf {
+public:
+    static const std::size_t DEFAULT_BLOCK = 1 << 16; ///< Default block size in bytes.
+
+    /**
+     * @brief Construct a writer for the given stream.
+     *
+     * @param target The stream that receives the blocks.
+     * @param block The block size in bytes.
+     */
+    explicit BlockWriter(std::ostream& target, std::size_t block = DEFAULT_BLOCK)
+        : target(target), buffer(std::max<std::size_t>(block, 64)) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+    BlockWriter(const BlockWriter&) = delete;
+    BlockWriter& operator=(const BlockWriter&) = delete;
+
+    /**
+     * @brief Flush the remaining output.
+     */
+    ~BlockWriter() { flush(); }
+
+    /**
+     * @brief Append a run of spaces.
+     *
+     * @param count The number of spaces.
+     */
+    void spaces(std::size_t count) {
+        while (count > 0) {
+            if (pptr() == epptr()) flush();
+            std::size_t n = std::min<std::size_t>(count, epptr() - pptr());
+            std::memset(pptr(), ' ', n);
+            pbump(static_cast<int>(n));
+            count -= n;
+        }
+    }
+
+    /**
+     * @brief Append one character.
+     *
+     * @param c The character.
+     */
+    void put(char c) {
+        if (pptr() == epptr()) flush();
+        *pptr() = c;
+        pbump(1);
+    }
+
+    /**
+     * @brief Hand the buffered output to the target stream.
+     *
+     * @return bool Whether the target stream is still good.
+     */
+    bool flush() {
+        std::ptrdiff_t n = pptr() - pbase();
+        if (n > 0) target.write(pbase(), n);
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return static_cast<bool>(target);
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!flush()) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override { return flush() ? 0 : -1; }
+
+private:
+    std::ostream& target;     ///< The stream receiving the blocks.
+    std::vector<char> buffer; ///< The block being filled.
+};
+
+/**
+ * @class LineReader
+ * @brief Reads a stream in large blocks and splits it into lines.
+ */
+class LineReader {
+public:
+    static const std::size_t DEFAULT_BLOCK = 1 << 16; ///< Default block size in bytes.
+
+    /**
+     * @brief Construct a reader for the given stream.
+     *
+     * @param source The stream to read.
+     * @param block The block size in bytes.
+     */
+    explicit LineReader(std::istream& source, std::size_t block = DEFAULT_BLOCK)
+        : source(source), block(std::max<std::size_t>(block, 64)), begin(0), end(0), begin_shift(0), line_count(0) {}
+
+    /**
+     * @brief Get the next line.
+     *
+     * The line excludes its '\n' and a trailing '\r'. The pointers stay valid until the next call.
+     *
+     * @param first Receives the start of the line.
+     * @param last Receives the end of the line.
+     * @return true If a line was read.
+     * @return false At the end of the input.
+     */
+    bool next(const char*& first, const char*& last) {
+        std::size_t scan = begin;
+        while (true) {
+            const char* data = buffer.data();
+            const void* newline = scan < end ? std::memchr(data + scan, '\n', end - scan) : nullptr;
+            if (newline) {
+                std::size_t stop = static_cast<const char*>(newline) - data;
+                emit(first, last, stop);
+                begin = stop + 1;
+                return true;
+            }
+            scan = end;
+            if (!fill()) {
+                if (begin == end) return false;
+                emit(first, last, end);
+                begin = end;
+                return true;
+            }
+            scan -= begin_shift;
+        }
+    }
+
+    /**
+     * @brief Get the number of lines returned so far.
+     *
+     * @return std::size_t The line count.
+     */
+    std::size_t lines() const { return line_count; }
+
+private:
+    std::istream& source;     ///< The stream being read.
+    std::size_t block;        ///< Bytes requested per read.
+    std::vector<char> buffer; ///< Unconsumed input in buffer[begin, end).
+    std::size_t begin;        ///< Start of the unconsumed input.
+    std::size_t end;          ///< End of the valid input.
+    std::size_t begin_shift;  ///< How far the last fill moved the unconsumed input.
+    std::size_t line_count;   ///< Lines returned so far.
+
+    /**
+     * @brief Set the line pointers and drop a trailing carriage return.
+     *
+     * @param first Receives the start of the line.
+     * @param last Receives the end of the line.
+     * @param stop The buffer position where the line ends.
+     */
+    void emit(const char*& first, const char*& last, std::size_t stop) {
+        first = buffer.data() + begin;
+        last = buffer.data() + stop;
+        if (last > first && last[-1] == '\r') --last;
+        ++line_count;
+    }
+
+    /**
+     * @brief Move the unconsumed input to the front and read another block behind it.
+     *
+     * @return true If more input was read.
+     * @return false At the end of the stream.
+     */
+    bool fill() {
+        begin_shift = begin;
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (buffer.size() < end + block) buffer.resize(end + block);
+        source.read(buffer.data() + end, static_cast<std::streamsize>(block));
+        std::size_t got = static_cast<std::size_t>(source.gcount());
+        end += got;
+        return got > 0;
+    }
+};
+
+#endif // TEXT_IO_HPP
@@ -6,7 +6,11 @@
  * @details
  * This file contains the declaration of the Tree class, which represents a k-ary tree. It provides 
  * methods for adding nodes and various iterators for traversing the tree (BFS, DFS, In-Order, 
- * Post-Order, Pre-Order, and Min-Heap).
+ * Post-Order, Pre-Order, Min-Heap, and a lazy best-first Frontier order). An optional key index
+ * can be enabled to resolve parent nodes in add_sub_node in O(1) expected time instead of a full
+ * tree search. Nodes may either be owned by the caller or created by the tree itself in a chunked
+ * arena, and the node layout is selectable through the NodeType template parameter. Large trees
+ * can be walked in parallel on a work-stealing thread pool.
  * 
  * Contact: wasimshebalny@gmail.com
  */
@@ -15,11 +19,24 @@
 #define TREE_HPP
 
 #include "node.hpp"
-#include <queue>
-#include <stack>
+#include "key_index.hpp"
+#include "node_arena.hpp"
+#include "frozen_tree.hpp"
+#include "parallel.hpp"
+#include "text_io.hpp"
+#include "tree_stats.hpp"
+#include "scratch_vector.hpp"
+#include <memory>
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 /**
  * @class Tree
@@ -30,11 +47,35 @@
  * 
  * @tparam T The type of the key stored in the nodes.
  * @tparam k The maximum number of children per node. Default is 2 (binary tree).
+ * @tparam NodeType The node type. Default is Node<T>, which keeps children in a std::vector;
+ * Node<T, k> keeps up to k children inline in the node, and SiblingNode<T> links children through
+ * first-child/next-sibling pointers. ParentNode<T> adds parent links, which enables the
+ * stackless pre-order and post-order iterators.
  */
-template <typename T, int k = 2>
-class Tree {
+template <typename T, int k = 2, typename NodeType = Node<T> >
+class Tree : private TreeStatsHolder<ActiveTreeStats> {
+    static_assert(NodeType::child_capacity == 0 || NodeType::child_capacity >= k,
+                  "the node type cannot hold k children");
+
+public:
+    typedef NodeType node_type; ///< The node type of the tree.
+    typedef ActiveTreeStats stats_type; ///< TreeStats with TREE_STATS defined, NoTreeStats otherwise.
+
 private:
-    Node<T>* root; ///< Pointer to the root node of the tree.
+    typedef KeyIndex<T, NodeType> index_type;
+    typedef typename NodeType::children_type::iterator child_iterator;
+
+    /**
+     * @brief A node on a root-to-node path and the next of its children to visit.
+     */
+    struct PathFrame {
+        NodeType* node;      ///< The node.
+        child_iterator next; ///< The next child to descend into.
+    };
+
+    NodeType* root; ///< Pointer to the root node of the tree.
+    std::shared_ptr<index_type> index; ///< Optional key index, null while disabled.
+    std::shared_ptr<NodeArena<NodeType> > arena; ///< Storage for tree-owned nodes, created on first use.
 
 public:
     /**
@@ -49,55 +90,595 @@ public:
      * 
      * @param root_node The node to be added as the root.
      */
-    void add_root(Node<T>& root_node) {
+    void add_root(NodeType& root_node) {
         root = &root_node;
+        if (index) {
+            index->clear();
+            index_subtree(root);
+        }
     }
 
     /**
      * @brief Add a child node to a specified parent node.
      * 
+     * The parent is resolved by key, through the key index when it is enabled and through
+     * find_node otherwise.
+     * 
      * @param parent_node The parent node.
      * @param sub_node The child node to be added.
+     * @return NodeType* The tree node the child was attached to, or nullptr if no node has the
+     * parent's key or that node already has k children.
+     */
+    NodeType* add_sub_node(NodeType& parent_node, NodeType& sub_node) {
+        NodeType* parent;
+        if (index) {
+            parent = index->lookup(parent_node.get_key());
+        } else {
+            std::uint64_t visits = counters().find_visits();
+            parent = find_node(root, parent_node);
+            counters().record_insert_search(counters().find_visits() - visits);
+        }
+        if (!parent) {
+            counters().count_failed_add(AddFailure::MissingParent);
+            return nullptr;
+        }
+        if (parent->children.size() >= k) {
+            counters().count_failed_add(AddFailure::FullParent);
+            return nullptr;
+        }
+        parent->add_child(&sub_node);
+        if (index) index_subtree(&sub_node);
+        return parent;
+    }
+
+    /**
+     * @brief Create a tree-owned root node.
+     * 
+     * The node lives in the tree's arena and is destroyed together with the tree (and every
+     * copy of it, since copies share the arena).
+     * 
+     * @param key The key of the root node.
+     * @return NodeType& Reference to the new root node.
+     */
+    NodeType& emplace_root(const T& key) {
+        NodeType* node = node_arena().create(key);
+        add_root(*node);
+        return *node;
+    }
+
+    /**
+     * @brief Create a tree-owned node and attach it as a child of the given node.
+     * 
+     * Unlike add_sub_node, the parent is used directly instead of being searched for by key,
+     * so it must be a node of this tree.
+     * 
+     * @param parent The parent node.
+     * @param key The key of the new node.
+     * @return NodeType* Pointer to the new node or nullptr if the parent already has k children.
+     */
+    NodeType* emplace_sub_node(NodeType& parent, const T& key) {
+        if (parent.children.size() >= k) {
+            counters().count_failed_add(AddFailure::FullParent);
+            return nullptr;
+        }
+        NodeType* node = node_arena().create(key);
+        parent.add_child(node);
+        if (index) index->insert(node);
+        return node;
+    }
+
+    /**
+     * @brief Reserve storage for tree-owned nodes that are about to be created.
+     * 
+     * @param count The number of nodes about to be created.
+     */
+    void reserve(std::size_t count) {
+        node_arena().reserve(count);
+        if (index) index->reserve(index->size() + count);
+    }
+
+    /**
+     * @brief Build the whole tree from a parent-index array in linear time.
+     * 
+     * Node i gets key keys[i] and becomes a child of node parents[i]; the single node with a
+     * negative parent becomes the root. Children keep increasing index order. Nodes are created
+     * in the tree's arena in breadth-first order and replace the current root; no key lookups
+     * are made. The input is validated before any node is created.
+     * 
+     * @param keys The key of every node.
+     * @param parents The parent index of every node, negative for the root.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If the sizes differ, there is not exactly one root, an
+     * index is out of range, a node would get more than k children, or the parents form a cycle.
+     */
+    template <typename Index>
+    NodeType& build_from_parents(const std::vector<T>& keys, const std::vector<Index>& parents) {
+        static_assert(std::is_signed<Index>::value, "parent indices must be signed");
+        std::size_t n = keys.size();
+        if (parents.size() != n) throw std::invalid_argument("build_from_parents: keys and parents differ in size");
+        std::vector<std::size_t> offsets(n + 2, 0);
+        std::size_t root_index = n;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (parents[i] < 0) {
+                if (root_index != n) throw std::invalid_argument("build_from_parents: more than one root");
+                root_index = i;
+            } else if (static_cast<std::size_t>(parents[i]) >= n) {
+                throw std::invalid_argument("build_from_parents: parent index out of range");
+            } else {
+                ++offsets[static_cast<std::size_t>(parents[i]) + 2];
+            }
+        }
+        if (root_index == n) throw std::invalid_argument("build_from_parents: no root");
+        for (std::size_t i = 2; i < n + 2; ++i) offsets[i] += offsets[i - 1];
+        std::vector<std::size_t> children(n - 1);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (parents[i] >= 0) children[offsets[static_cast<std::size_t>(parents[i]) + 1]++] = i;
+        }
+        return build_linked(keys, root_index, offsets, children);
+    }
+
+    /**
+     * @brief Build the whole tree from an edge list in linear time.
+     * 
+     * Each edge is a (parent, child) pair of node indices; the one node that is nobody's child
+     * becomes the root. Children keep the order of their edges.
+     * 
+     * @param keys The key of every node.
+     * @param edges The (parent, child) edges, n - 1 of them for n nodes.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If an index is out of range, a node has two parents, there
+     * is not exactly one root, a node would get more than k children, or the edges form a cycle.
+     * @see build_from_parents
+     */
+    template <typename Index>
+    NodeType& build_from_edges(const std::vector<T>& keys, const std::vector<std::pair<Index, Index> >& edges) {
+        std::size_t n = keys.size();
+        if (n == 0 || edges.size() != n - 1) throw std::invalid_argument("build_from_edges: a tree of n nodes needs n - 1 edges");
+        std::vector<std::size_t> offsets(n + 2, 0);
+        std::vector<char> has_parent(n, 0);
+        for (auto& edge : edges) {
+            if (edge.first < 0 || edge.second < 0 ||
+                static_cast<std::size_t>(edge.first) >= n || static_cast<std::size_t>(edge.second) >= n) {
+                throw std::invalid_argument("build_from_edges: node index out of range");
+            }
+            if (has_parent[static_cast<std::size_t>(edge.second)]) throw std::invalid_argument("build_from_edges: node with two parents");
+            has_parent[static_cast<std::size_t>(edge.second)] = 1;
+            ++offsets[static_cast<std::size_t>(edge.first) + 2];
+        }
+        std::size_t root_index = std::find(has_parent.begin(), has_parent.end(), 0) - has_parent.begin();
+        for (std::size_t i = 2; i < n + 2; ++i) offsets[i] += offsets[i - 1];
+        std::vector<std::size_t> children(n - 1);
+        for (auto& edge : edges) {
+            children[offsets[static_cast<std::size_t>(edge.first) + 1]++] = static_cast<std::size_t>(edge.second);
+        }
+        return build_linked(keys, root_index, offsets, children);
+    }
+
+    /**
+     * @class PreOrderBuilder
+     * @brief Builds a tree incrementally from nodes given in pre-order with their child counts.
+     * 
+     * Every node is created in the tree's arena and linked to the innermost node that still
+     * expects children, so each push is O(1) and no key lookups are made. The nodes hang under a
+     * root of the builder's own until finish, which makes that root the tree's root and adds the
+     * nodes to the key index; until then, and whenever a push or finish throws, the tree is
+     * left as it was.
+     */
+    class PreOrderBuilder {
+    public:
+        /**
+         * @brief Construct a builder that fills the given tree.
+         * 
+         * @param tree The tree to build.
+         */
+        explicit PreOrderBuilder(Tree& tree) : tree(tree), root(nullptr), count(0) {}
+
+        /**
+         * @brief Add the next node of the pre-order sequence.
+         * 
+         * @param key The key of the node.
+         * @param child_count The number of children that follow the node in the sequence.
+         * @return NodeType& The new node.
+         * @throws std::invalid_argument If child_count exceeds k or the tree is already complete.
+         */
+        NodeType& push(const T& key, std::size_t child_count) {
+            if (child_count > static_cast<std::size_t>(k)) {
+                throw std::invalid_argument("pre-order build: node " + std::to_string(count) + " has more than k children");
+            }
+            if (complete()) throw std::invalid_argument("pre-order build: node after the last one");
+            NodeType* node = tree.node_arena().create(key);
+            if (!root) {
+                root = node;
+            } else {
+                Open& parent = open.back();
+                parent.node->add_child(node);
+                if (--parent.remaining == 0) open.pop_back();
+            }
+            if (child_count > 0) {
+                Open entry = {node, child_count};
+                open.push_back(entry);
+            }
+            ++count;
+            return *node;
+        }
+
+        /**
+         * @brief Check whether every announced child has arrived.
+         * 
+         * @return true If the root has been pushed and no node is waiting for children.
+         * @return false Otherwise.
+         */
+        bool complete() const { return root && open.empty(); }
+
+        /**
+         * @brief Get the number of nodes pushed so far.
+         * 
+         * @return std::size_t The number of nodes.
+         */
+        std::size_t size() const { return count; }
+
+        /**
+         * @brief Finish the build and make the built tree the tree's content.
+         * 
+         * @return NodeType& The root of the built tree.
+         * @throws std::invalid_argument If the sequence ended before the tree was complete, in
+         * which case the tree is unchanged.
+         */
+        NodeType& finish() {
+            if (!complete()) throw std::invalid_argument("pre-order build: sequence ended early");
+            if (tree.root != root) tree.add_root(*root);
+            return *root;
+        }
+
+    private:
+        /**
+         * @brief A node that still expects children.
+         */
+        struct Open {
+            NodeType* node;        ///< The node.
+            std::size_t remaining; ///< Number of children still to come.
+        };
+
+        Tree& tree;             ///< The tree being built.
+        NodeType* root;         ///< The first node pushed.
+        std::size_t count;      ///< Number of nodes pushed.
+        std::vector<Open> open; ///< Nodes still expecting children, innermost last.
+    };
+
+    /**
+     * @brief Build the whole tree from a pre-order sequence of (key, child count) pairs.
+     * 
+     * @param first Iterator to the first pair.
+     * @param last Iterator past the last pair.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If the sequence does not describe exactly one tree with at
+     * most k children per node; the tree is then left unchanged.
+     * @see PreOrderBuilder
+     */
+    template <typename InputIt>
+    NodeType& build_from_pre_order(InputIt first, InputIt last) {
+        PreOrderBuilder builder(*this);
+        for (; first != last; ++first) {
+            builder.push(first->first, static_cast<std::size_t>(first->second));
+        }
+        return builder.finish();
+    }
+
+    /**
+     * @brief Read a tree from a stream of whitespace-separated "key child_count" pairs in pre-order.
+     * 
+     * Reading stops as soon as the tree is complete, so several trees can follow each other in
+     * one stream and nodes are linked while the rest of the input is still arriving.
+     * 
+     * @param in The input stream; the key type needs an operator>>.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If the input is malformed or ends before the tree is
+     * complete; the tree is then left unchanged.
+     */
+    NodeType& read_pre_order(std::istream& in) {
+        PreOrderBuilder builder(*this);
+        do {
+            T key;
+            std::size_t child_count;
+            if (!(in >> key >> child_count)) {
+                throw std::invalid_argument("pre-order build: malformed or truncated input after " +
+                                            std::to_string(builder.size()) + " nodes");
+            }
+            builder.push(key, child_count);
+        } while (!builder.complete());
+        return builder.finish();
+    }
+
+    /**
+     * @brief Get the memory used by the nodes reachable from the root.
+     * 
+     * Counts each node's own size plus the heap memory held by its child container. Allocator
+     * bookkeeping and unused arena slots are not included.
+     * 
+     * @return std::size_t The number of bytes used by the nodes.
+     */
+    std::size_t memory_usage() const {
+        std::size_t bytes = 0;
+        // An unprobed iterator, so this internal walk does not show up in the stats
+        for (BFSIterator it(root), last(nullptr); it != last; ++it) {
+            bytes += sizeof(NodeType) + child_heap_bytes(it->children);
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief Take an immutable breadth-first snapshot of the tree.
+     * 
+     * Later changes to the tree are not reflected in the snapshot.
+     * 
+     * @return FrozenTree<T> The snapshot, empty if the tree has no root.
+     * @throws std::length_error If the tree has more nodes than FrozenTree<T>::index_type can
+     * number.
+     */
+    FrozenTree<T> freeze() const {
+        typedef typename FrozenTree<T>::index_type index_t;
+        std::vector<T> keys;
+        std::vector<index_t> first_child;
+        if (root) {
+            std::vector<NodeType*> order(1, root);
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                for (auto child : order[i]->children) {
+                    order.push_back(child);
+                }
+            }
+            if (order.size() > std::numeric_limits<index_t>::max()) {
+                throw std::length_error("freeze: too many nodes for the snapshot index type");
+            }
+            first_child.reserve(order.size() + 1);
+            std::size_t next = 1;
+            for (auto node : order) {
+                first_child.push_back(static_cast<index_t>(next));
+                next += node->children.size();
+            }
+            keys.reserve(order.size());
+            for (auto node : order) keys.push_back(node->get_key());
+        }
+        first_child.push_back(static_cast<index_t>(keys.size()));
+        return FrozenTree<T>(k, std::move(keys), std::move(first_child));
+    }
+
+    /**
+     * @brief Call a function on every node, walking subtrees in parallel.
+     * 
+     * The tree is split at subtree boundaries: nodes with several children hand each child's
+     * subtree to the pool as a separate task while the pool is short of work, and any other
+     * subtree is walked sequentially by the task that reached it. Nodes are visited in no
+     * particular global order, but with Traversal::PostOrder every node is visited after all
+     * of its descendants, and with any other order every node is visited before all of its
+     * descendants. The function is called concurrently and must be thread-safe. If it throws,
+     * the first exception is rethrown once the walk has finished.
+     * 
+     * @param order The traversal order, which decides whether parents come first or last.
+     * @param fn The function, called as fn(node).
+     * @param pool The pool to run on.
+     */
+    template <typename F>
+    void parallel_for_each(Traversal order, F fn, WorkStealingPool& pool = WorkStealingPool::shared()) const {
+        if (!root) return;
+        ParallelWalk<F> walk(order == Traversal::PostOrder, fn, pool);
+        walk.run(root);
+    }
+
+    /**
+     * @brief Transform every key and combine the results in parallel.
+     * 
+     * The reduction follows the shape of the tree: a node's result is its transformed key
+     * combined, left to right, with the results of its child subtrees. Subtrees are reduced in
+     * parallel as in parallel_for_each, but the grouping of operations does not depend on how
+     * the work was split or scheduled, so floating-point results (double, Complex) are
+     * identical from run to run and for any number of threads. For an associative op the
+     * result equals folding the transformed keys in pre-order.
+     * 
+     * @param init The initial value, combined as op(init, tree result).
+     * @param op The associative binary operation, called concurrently.
+     * @param transform The function applied to every key, called concurrently.
+     * @param pool The pool to run on.
+     * @return R The reduced value, or init for an empty tree.
+     */
+    template <typename R, typename Op, typename Tx>
+    R transform_reduce(R init, Op op, Tx transform, WorkStealingPool& pool = WorkStealingPool::shared()) const {
+        if (!root) return init;
+        ParallelReduce<R, Op, Tx> reduction(op, transform, pool);
+        return op(init, reduction.run(root, init));
+    }
+
+    /**
+     * @brief Combine all keys in parallel.
+     * 
+     * @param init The initial value, combined as op(init, tree result).
+     * @param op The associative binary operation, called concurrently.
+     * @param pool The pool to run on.
+     * @return R The reduced value, or init for an empty tree.
+     * @see transform_reduce
+     */
+    template <typename R, typename Op>
+    R reduce(R init, Op op, WorkStealingPool& pool = WorkStealingPool::shared()) const {
+        return transform_reduce(init, op, [](const T& key) { return R(key); }, pool);
+    }
+
+    /**
+     * @brief Count the keys that satisfy a predicate, in parallel.
+     * 
+     * @param pred The predicate, called concurrently.
+     * @param pool The pool to run on.
+     * @return std::size_t The number of matching keys.
+     */
+    template <typename Pred>
+    std::size_t count_if(Pred pred, WorkStealingPool& pool = WorkStealingPool::shared()) const {
+        return transform_reduce(std::size_t(0), [](std::size_t a, std::size_t b) { return a + b; },
+                                [&pred](const T& key) { return pred(key) ? std::size_t(1) : std::size_t(0); }, pool);
+    }
+
+    /**
+     * @brief Enable the key index and build it from the current tree.
+     * 
+     * While enabled, add_root and add_sub_node keep the index up to date. When several nodes
+     * share a key, the index resolves it to the first one added, whereas find_node returns the
+     * first one in depth-first order. Changing keys or children directly on the nodes requires
+     * calling rebuild_key_index afterwards. For key types without std::hash the call does
+     * nothing and add_sub_node keeps resolving parents with find_node.
+     */
+    void enable_key_index() {
+        if (!is_hashable_key<T>::value) return;
+        index = std::make_shared<index_type>();
+        index_subtree(root);
+    }
+
+    /**
+     * @brief Disable the key index and release its memory.
+     */
+    void disable_key_index() {
+        index.reset();
+    }
+
+    /**
+     * @brief Rebuild the key index from the current tree.
      */
-    void add_sub_node(Node<T>& parent_node, Node<T>& sub_node) {
-        Node<T>* parent = find_node(root, parent_node);
-        if (parent && parent->children.size() < k) {
-            parent->add_child(&sub_node);
+    void rebuild_key_index() {
+        if (index) {
+            index->clear();
+            index_subtree(root);
         }
     }
 
+    /**
+     * @brief Check whether the key index is enabled.
+     * 
+     * @return true If add_sub_node resolves parents through the key index.
+     * @return false If add_sub_node resolves parents with find_node.
+     */
+    bool has_key_index() const {
+        return static_cast<bool>(index);
+    }
+
+    /**
+     * @brief Get the instrumentation counters of the tree.
+     *
+     * With TREE_STATS defined these are TreeStats counters updated by find_node, add_sub_node,
+     * emplace_sub_node and the traversals started by the begin_* functions; otherwise they are
+     * a NoTreeStats that records nothing. Either can be written with write_text or write_json.
+     *
+     * @return const stats_type& The counters().
+     */
+    const stats_type& stats() const {
+        return counters();
+    }
+
+    /**
+     * @brief Reset the instrumentation counters to zero.
+     */
+    void reset_stats() {
+        counters() = stats_type();
+    }
+
     /**
      * @brief Find a node in the tree.
      * 
-     * @param current The current node in the search.
+     * The subtree is searched in pre-order with an explicit stack, so the search does not
+     * recurse. Without TREE_STATS any number of threads may search the same tree at once; with
+     * it, each search adds its visit count to the shared counters, so searches must not overlap.
+     * 
+     * @param current The root of the subtree to search.
      * @param target The target node to find.
-     * @return Node<T>* Pointer to the found node or nullptr if not found.
+     * @return NodeType* Pointer to the first node in pre-order with the target's key, or
+     * nullptr if not found.
      */
-    Node<T>* find_node(Node<T>* current, Node<T>& target) {
-        if (!current) return nullptr;
-        if (current->get_key() == target.get_key()) return current;
+    NodeType* find_node(NodeType* current, NodeType& target) {
+        std::vector<NodeType*> pending;
+        return search(current, target, pending);
+    }
+
+    /**
+     * @class TraversalScratch
+     * @brief Reusable storage for the stacks, queues and heaps of the traversal iterators.
+     * 
+     * An iterator started by a begin_* overload that takes a scratch borrows its storage and
+     * returns it when the iterator is destroyed, so repeated traversals stop allocating once
+     * the storage has grown to the largest of them, or right away after presize_scratch. A
+     * scratch serves one traversal at a time; a traversal started while another holds the
+     * storage allocates as usual.
+     */
+    class TraversalScratch {
+    public:
+        /**
+         * @brief Get the number of node pointers the scratch holds without allocating.
+         * 
+         * @return std::size_t The capacity of the node storage.
+         */
+        std::size_t capacity() const {
+            return nodes.capacity();
+        }
+
+    private:
+        friend class Tree;
+
+        std::vector<NodeType*> nodes;  ///< Storage of every iterator but the post-order one.
+        std::vector<PathFrame> frames; ///< Storage of the post-order iterator.
+    };
 
-        for (auto& child : current->children) {
-            auto found = find_node(child, target);
-            if (found) return found;
+    /**
+     * @brief Grow a scratch so that no traversal of the tree allocates with it.
+     * 
+     * One breadth-first pass sizes the node storage for all nodes, which the min-heap iterator
+     * needs and bounds every other stack and queue, and the post-order storage for the height.
+     * 
+     * @param scratch The scratch to grow.
+     */
+    void presize_scratch(TraversalScratch& scratch) const {
+        std::vector<NodeType*>& nodes = scratch.nodes;
+        nodes.clear();
+        if (root) nodes.push_back(root);
+        std::size_t height = 0;
+        for (std::size_t next = 0; next < nodes.size(); ++height) {
+            for (std::size_t level_end = nodes.size(); next < level_end; ++next) {
+                for (auto child : nodes[next]->children) {
+                    nodes.push_back(child);
+                }
+            }
         }
+        nodes.clear();
+        scratch.frames.reserve(height);
+    }
 
-        return nullptr;
+    /**
+     * @brief Find a node in the tree, keeping the search stack in a scratch.
+     * 
+     * Repeated searches with the same scratch stop allocating once its storage has grown to
+     * the widest search.
+     * 
+     * @param current The root of the subtree to search.
+     * @param target The target node to find.
+     * @param scratch The scratch whose storage holds the search stack.
+     * @return NodeType* Pointer to the first node in pre-order with the target's key, or
+     * nullptr if not found.
+     */
+    NodeType* find_node(NodeType* current, NodeType& target, TraversalScratch& scratch) {
+        ScratchVector<NodeType*> pending(&scratch.nodes);
+        return search(current, target, pending);
     }
 
     /**
      * @class BFSIterator
      * @brief An iterator for traversing the tree in breadth-first order.
      */
-    class BFSIterator {
+    class BFSIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new BFSIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the queue, or nullptr.
          */
-        BFSIterator(Node<T>* root) {
-            if (root) queue.push(root);
+        BFSIterator(NodeType* root, stats_type* stats = nullptr, std::vector<NodeType*>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::BFS), queue(storage), head(0) {
+            if (root) queue.push_back(root);
+            track(queue.size());
         }
 
         /**
@@ -108,7 +689,7 @@ public:
          * @return false If the iterators are equal.
          */
         bool operator!=(const BFSIterator& other) const {
-            return !queue.empty();
+            return head < queue.size();
         }
 
         /**
@@ -117,34 +698,40 @@ public:
          * @return BFSIterator& Reference to the incremented iterator.
          */
         BFSIterator& operator++() {
-            auto node = queue.front();
-            queue.pop();
-            for (auto& child : node->children) {
-                queue.push(child);
+            auto node = queue[head++];
+            for (auto child : node->children) {
+                queue.push_back(child);
+            }
+            if (2 * head >= queue.size()) {
+                // Drop the visited half; each node is moved at most once per halving, O(1) amortized
+                queue.erase(queue.begin(), queue.begin() + head);
+                head = 0;
             }
+            track(queue.size() - head);
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
-            return *queue.front();
+        NodeType& operator*() const {
+            return *queue[head];
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
-            return queue.front();
+        NodeType* operator->() const {
+            return queue[head];
         }
 
     private:
-        std::queue<Node<T>*> queue; ///< Queue for BFS traversal.
+        ScratchVector<NodeType*> queue; ///< Queue for BFS traversal, visited nodes before head.
+        std::size_t head;               ///< Position of the current node in the queue.
     };
 
     /**
@@ -153,7 +740,7 @@ public:
      * @return BFSIterator An iterator to the beginning of the BFS traversal.
      */
     BFSIterator begin_bfs() const {
-        return BFSIterator(root);
+        return BFSIterator(root, &counters());
     }
 
     /**
@@ -165,19 +752,33 @@ public:
         return BFSIterator(nullptr);
     }
 
+    /**
+     * @brief Get an iterator to the beginning of the BFS traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return BFSIterator An iterator to the beginning of the BFS traversal.
+     */
+    BFSIterator begin_bfs(TraversalScratch& scratch) const {
+        return BFSIterator(root, &counters(), &scratch.nodes);
+    }
+
     /**
      * @class DFSIterator
      * @brief An iterator for traversing the tree in depth-first order.
      */
-    class DFSIterator {
+    class DFSIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new DFSIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the stack, or nullptr.
          */
-        DFSIterator(Node<T>* root) {
-            if (root) stack.push(root);
+        DFSIterator(NodeType* root, stats_type* stats = nullptr, std::vector<NodeType*>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::DFS), stack(storage) {
+            if (root) stack.push_back(root);
+            track(stack.size());
         }
 
         /**
@@ -197,34 +798,33 @@ public:
          * @return DFSIterator& Reference to the incremented iterator.
          */
         DFSIterator& operator++() {
-            auto node = stack.top();
-            stack.pop();
-            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
-                stack.push(*it);
-            }
+            NodeType* node = stack.back();
+            stack.pop_back();
+            push_children_reversed(stack, node);
+            track(stack.size());
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
-            return *stack.top();
+        NodeType& operator*() const {
+            return *stack.back();
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
-            return stack.top();
+        NodeType* operator->() const {
+            return stack.back();
         }
 
     private:
-        std::stack<Node<T>*> stack; ///< Stack for DFS traversal.
+        ScratchVector<NodeType*> stack; ///< Stack for DFS traversal.
     };
 
     /**
@@ -233,7 +833,7 @@ public:
      * @return DFSIterator An iterator to the beginning of the DFS traversal.
      */
     DFSIterator begin_dfs() const {
-        return DFSIterator(root);
+        return DFSIterator(root, &counters());
     }
 
     /**
@@ -245,19 +845,33 @@ public:
         return DFSIterator(nullptr);
     }
 
+    /**
+     * @brief Get an iterator to the beginning of the DFS traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return DFSIterator An iterator to the beginning of the DFS traversal.
+     */
+    DFSIterator begin_dfs(TraversalScratch& scratch) const {
+        return DFSIterator(root, &counters(), &scratch.nodes);
+    }
+
     /**
      * @class InOrderIterator
      * @brief An iterator for traversing the tree in in-order.
      */
-    class InOrderIterator {
+    class InOrderIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new InOrderIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the stack, or nullptr.
          */
-        InOrderIterator(Node<T>* root) {
+        InOrderIterator(NodeType* root, stats_type* stats = nullptr, std::vector<NodeType*>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::InOrder), stack(storage) {
             push_left(root);
+            track(stack.size());
         }
 
         /**
@@ -277,43 +891,44 @@ public:
          * @return InOrderIterator& Reference to the incremented iterator.
          */
         InOrderIterator& operator++() {
-            Node<T>* node = stack.top();
-            stack.pop();
+            NodeType* node = stack.back();
+            stack.pop_back();
             if (node->children.size() > 1) {
                 push_left(node->children[1]);
             }
+            track(stack.size());
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
-            return *stack.top();
+        NodeType& operator*() const {
+            return *stack.back();
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
-            return stack.top();
+        NodeType* operator->() const {
+            return stack.back();
         }
 
     private:
-        std::stack<Node<T>*> stack; ///< Stack for in-order traversal.
+        ScratchVector<NodeType*> stack; ///< Stack for in-order traversal.
 
         /**
          * @brief Push all left children of the node onto the stack.
          * 
          * @param node The starting node.
          */
-        void push_left(Node<T>* node) {
+        void push_left(NodeType* node) {
             while (node) {
-                stack.push(node);
+                stack.push_back(node);
                 if (!node->children.empty()) {
                     node = node->children[0];
                 } else {
@@ -329,7 +944,7 @@ public:
      * @return InOrderIterator An iterator to the beginning of the in-order traversal.
      */
     InOrderIterator begin_in_order() const {
-        return InOrderIterator(root);
+        return InOrderIterator(root, &counters());
     }
 
     /**
@@ -341,29 +956,37 @@ public:
         return InOrderIterator(nullptr);
     }
 
+    /**
+     * @brief Get an iterator to the beginning of the in-order traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return InOrderIterator An iterator to the beginning of the in-order traversal.
+     */
+    InOrderIterator begin_in_order(TraversalScratch& scratch) const {
+        return InOrderIterator(root, &counters(), &scratch.nodes);
+    }
+
     /**
      * @class PostOrderIterator
      * @brief An iterator for traversing the tree in post-order.
+     * 
+     * The iterator advances lazily: it keeps one frame per level of the current root-to-node
+     * path, so memory is bounded by the tree height and the first node is reached in
+     * O(height) steps.
      */
-    class PostOrderIterator {
+    class PostOrderIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new PostOrderIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the path, or nullptr.
          */
-        PostOrderIterator(Node<T>* root) {
-            if (root) {
-                stack.push(root);
-                while (!stack.empty()) {
-                    Node<T>* node = stack.top();
-                    stack.pop();
-                    output.push(node);
-                    for (auto& child : node->children) {
-                        stack.push(child);
-                    }
-                }
-            }
+        PostOrderIterator(NodeType* root, stats_type* stats = nullptr, std::vector<PathFrame>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::PostOrder), stack(storage) {
+            if (root) descend(root);
+            track(stack.size());
         }
 
         /**
@@ -374,7 +997,7 @@ public:
          * @return false If the iterators are equal.
          */
         bool operator!=(const PostOrderIterator& other) const {
-            return !output.empty();
+            return !stack.empty();
         }
 
         /**
@@ -383,31 +1006,58 @@ public:
          * @return PostOrderIterator& Reference to the incremented iterator.
          */
         PostOrderIterator& operator++() {
-            output.pop();
+            stack.pop_back();
+            if (!stack.empty()) {
+                PathFrame& parent = stack.back();
+                if (parent.next != parent.node->children.end()) {
+                    NodeType* child = *parent.next;
+                    ++parent.next;
+                    descend(child);
+                }
+            }
+            track(stack.size());
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
-            return *output.top();
+        NodeType& operator*() const {
+            return *stack.back().node;
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
-            return output.top();
+        NodeType* operator->() const {
+            return stack.back().node;
         }
 
     private:
-        std::stack<Node<T>*> stack; ///< Stack for post-order traversal.
-        std::stack<Node<T>*> output; ///< Stack for storing the post-order output.
+        ScratchVector<PathFrame> stack; ///< Path from the root to the current node.
+
+        /**
+         * @brief Push the path from the node down to its leftmost leaf.
+         * 
+         * @param node The starting node.
+         */
+        void descend(NodeType* node) {
+            while (true) {
+                child_iterator next = node->children.begin();
+                if (next == node->children.end()) {
+                    stack.push_back(PathFrame{node, next});
+                    return;
+                }
+                NodeType* child = *next;
+                ++next;
+                stack.push_back(PathFrame{node, next});
+                node = child;
+            }
+        }
     };
 
     /**
@@ -416,7 +1066,7 @@ public:
      * @return PostOrderIterator An iterator to the beginning of the post-order traversal.
      */
     PostOrderIterator begin_post_order() const {
-        return PostOrderIterator(root);
+        return PostOrderIterator(root, &counters());
     }
 
     /**
@@ -428,19 +1078,33 @@ public:
         return PostOrderIterator(nullptr);
     }
 
+    /**
+     * @brief Get an iterator to the beginning of the post-order traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return PostOrderIterator An iterator to the beginning of the post-order traversal.
+     */
+    PostOrderIterator begin_post_order(TraversalScratch& scratch) const {
+        return PostOrderIterator(root, &counters(), &scratch.frames);
+    }
+
     /**
      * @class PreOrderIterator
      * @brief An iterator for traversing the tree in pre-order.
      */
-    class PreOrderIterator {
+    class PreOrderIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new PreOrderIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the stack, or nullptr.
          */
-        PreOrderIterator(Node<T>* root) {
-            if (root) stack.push(root);
+        PreOrderIterator(NodeType* root, stats_type* stats = nullptr, std::vector<NodeType*>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::PreOrder), stack(storage) {
+            if (root) stack.push_back(root);
+            track(stack.size());
         }
 
         /**
@@ -460,34 +1124,33 @@ public:
          * @return PreOrderIterator& Reference to the incremented iterator.
          */
         PreOrderIterator& operator++() {
-            auto node = stack.top();
-            stack.pop();
-            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
-                stack.push(*it);
-            }
+            NodeType* node = stack.back();
+            stack.pop_back();
+            push_children_reversed(stack, node);
+            track(stack.size());
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
-            return *stack.top();
+        NodeType& operator*() const {
+            return *stack.back();
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
-            return stack.top();
+        NodeType* operator->() const {
+            return stack.back();
         }
 
     private:
-        std::stack<Node<T>*> stack; ///< Stack for pre-order traversal.
+        ScratchVector<NodeType*> stack; ///< Stack for pre-order traversal.
     };
 
     /**
@@ -496,7 +1159,7 @@ public:
      * @return PreOrderIterator An iterator to the beginning of the pre-order traversal.
      */
     PreOrderIterator begin_pre_order() const {
-        return PreOrderIterator(root);
+        return PreOrderIterator(root, &counters());
     }
 
     /**
@@ -508,22 +1171,39 @@ public:
         return PreOrderIterator(nullptr);
     }
 
+    /**
+     * @brief Get an iterator to the beginning of the pre-order traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return PreOrderIterator An iterator to the beginning of the pre-order traversal.
+     */
+    PreOrderIterator begin_pre_order(TraversalScratch& scratch) const {
+        return PreOrderIterator(root, &counters(), &scratch.nodes);
+    }
+
     /**
      * @class MinHeapIterator
      * @brief An iterator for traversing the tree in min-heap order.
+     * 
+     * Nodes come out in ascending key order; the order among nodes with equal keys is
+     * unspecified.
      */
-    class MinHeapIterator {
+    class MinHeapIterator : private stats_type::Probe {
     public:
         /**
          * @brief Construct a new MinHeapIterator object.
          * 
          * @param root The root node of the tree.
+         * @param stats The counters that record the traversal, or nullptr.
+         * @param storage Storage to borrow for the heap, or nullptr.
          */
-        MinHeapIterator(Node<T>* root) {
+        MinHeapIterator(NodeType* root, stats_type* stats = nullptr, std::vector<NodeType*>* storage = nullptr)
+            : stats_type::Probe(stats, IteratorKind::MinHeap), heap(storage) {
             if (root) {
                 populate_heap(root);
                 std::make_heap(heap.begin(), heap.end(), compare_nodes);
             }
+            track(heap.size());
         }
 
         /**
@@ -545,40 +1225,44 @@ public:
         MinHeapIterator& operator++() {
             std::pop_heap(heap.begin(), heap.end(), compare_nodes);
             heap.pop_back();
+            track(heap.size());
             return *this;
         }
 
         /**
          * @brief Dereference operator to access the current node.
          * 
-         * @return Node<T>& Reference to the current node.
+         * @return NodeType& Reference to the current node.
          */
-        Node<T>& operator*() const {
+        NodeType& operator*() const {
             return *heap.front();
         }
 
         /**
          * @brief Arrow operator to access the current node.
          * 
-         * @return Node<T>* Pointer to the current node.
+         * @return NodeType* Pointer to the current node.
          */
-        Node<T>* operator->() const {
+        NodeType* operator->() const {
             return heap.front();
         }
 
     private:
-        std::vector<Node<T>*> heap; ///< Vector to store the heap nodes.
+        ScratchVector<NodeType*> heap; ///< Vector to store the heap nodes.
 
         /**
          * @brief Populate the heap with nodes starting from the given node.
          * 
          * @param node The starting node.
          */
-        void populate_heap(Node<T>* node) {
+        void populate_heap(NodeType* node) {
             if (!node) return;
+            // The heap doubles as the breadth-first work list, so no recursion or extra memory is needed
             heap.push_back(node);
-            for (auto& child : node->children) {
-                populate_heap(child);
+            for (std::size_t next = 0; next < heap.size(); ++next) {
+                for (auto child : heap[next]->children) {
+                    heap.push_back(child);
+                }
             }
         }
 
@@ -590,7 +1274,7 @@ public:
          * @return true If the first node is greater than the second node.
          * @return false If the first node is not greater than the second node.
          */
-        static bool compare_nodes(Node<T>* a, Node<T>* b) {
+        static bool compare_nodes(NodeType* a, NodeType* b) {
             return a->get_key() > b->get_key();
         }
     };
@@ -601,7 +1285,7 @@ public:
      * @return MinHeapIterator An iterator to the beginning of the min-heap traversal.
      */
     MinHeapIterator begin_min_heap() const {
-        return MinHeapIterator(root);
+        return MinHeapIterator(root, &counters());
     }
 
     /**
@@ -614,26 +1298,484 @@ public:
     }
 
     /**
-     * @brief Get an iterator to the beginning of the BFS traversal.
-     * 
-     * This is the default traversal method.
+     * @brief Get an iterator to the beginning of the min-heap traversal that borrows a scratch's storage.
      * 
-     * @return BFSIterator An iterator to the beginning of the BFS traversal.
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return MinHeapIterator An iterator to the beginning of the min-heap traversal.
      */
-    BFSIterator begin() const {
-        return begin_bfs();
+    MinHeapIterator begin_min_heap(TraversalScratch& scratch) const {
+        return MinHeapIterator(root, &counters(), &scratch.nodes);
     }
 
     /**
-     * @brief Get an iterator to the end of the BFS traversal.
-     * 
-     * This is the default traversal method.
+     * @class FrontierIterator
+     * @brief An iterator that expands the tree best-first from the root.
      * 
-     * @return BFSIterator An iterator to the end of the BFS traversal.
+     * A binary heap holds the frontier of nodes whose parents have been visited, and each
+     * step visits the smallest key on the frontier. On a heap-ordered tree (every parent key no
+     * greater than its children's keys) this yields nodes in ascending key order, like
+     * MinHeapIterator, but lazily: the first m nodes cost O(m k log(m k)) time and memory no
+     * matter how large the tree is. On other trees keys below a larger ancestor come out late.
      */
-    BFSIterator end() const {
-        return end_bfs();
-    }
+    class FrontierIterator {
+    public:
+        /**
+         * @brief Construct a new FrontierIterator object.
+         * 
+         * @param root The root node of the tree.
+         * @param storage Storage to borrow for the frontier heap, or nullptr.
+         */
+        FrontierIterator(NodeType* root, std::vector<NodeType*>* storage = nullptr) : frontier(storage) {
+            if (root) frontier.push_back(root);
+        }
+
+        /**
+         * @brief Inequality operator to compare two iterators.
+         * 
+         * @param other The other iterator to compare to.
+         * @return true If the iterators are not equal.
+         * @return false If the iterators are equal.
+         */
+        bool operator!=(const FrontierIterator& other) const {
+            return !frontier.empty();
+        }
+
+        /**
+         * @brief Increment the iterator.
+         * 
+         * @return FrontierIterator& Reference to the incremented iterator.
+         */
+        FrontierIterator& operator++() {
+            NodeType* node = frontier.front();
+            std::pop_heap(frontier.begin(), frontier.end(), GreaterKey());
+            frontier.pop_back();
+            for (auto child : node->children) {
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), GreaterKey());
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Dereference operator to access the current node.
+         * 
+         * @return NodeType& Reference to the current node.
+         */
+        NodeType& operator*() const {
+            return *frontier.front();
+        }
+
+        /**
+         * @brief Arrow operator to access the current node.
+         * 
+         * @return NodeType* Pointer to the current node.
+         */
+        NodeType* operator->() const {
+            return frontier.front();
+        }
+
+    private:
+        /**
+         * @brief Order nodes so that the smallest key is on top of the heap.
+         */
+        struct GreaterKey {
+            bool operator()(NodeType* a, NodeType* b) const {
+                return a->get_key() > b->get_key();
+            }
+        };
+
+        ScratchVector<NodeType*> frontier; ///< Heap of the unvisited nodes whose parents were visited.
+    };
+
+    /**
+     * @brief Get an iterator to the beginning of the frontier traversal.
+     * 
+     * @return FrontierIterator An iterator to the beginning of the frontier traversal.
+     */
+    FrontierIterator begin_frontier() const {
+        return FrontierIterator(root);
+    }
+
+    /**
+     * @brief Get an iterator to the end of the frontier traversal.
+     * 
+     * @return FrontierIterator An iterator to the end of the frontier traversal.
+     */
+    FrontierIterator end_frontier() const {
+        return FrontierIterator(nullptr);
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the frontier traversal that borrows a scratch's storage.
+     * 
+     * @param scratch The scratch to borrow from until the iterator is destroyed.
+     * @return FrontierIterator An iterator to the beginning of the frontier traversal.
+     */
+    FrontierIterator begin_frontier(TraversalScratch& scratch) const {
+        return FrontierIterator(root, &scratch.nodes);
+    }
+
+    /**
+     * @class StacklessPreOrderIterator
+     * @brief A pre-order (depth-first) iterator that uses parent links instead of a stack.
+     * 
+     * Only available for node types with parent links, such as ParentNode. Each step moves to
+     * the first child or climbs to the next sibling of the nearest ancestor, so the iterator
+     * takes O(1) memory and never allocates.
+     */
+    class StacklessPreOrderIterator {
+    public:
+        /**
+         * @brief Construct a new StacklessPreOrderIterator object.
+         * 
+         * @param root The root node of the tree.
+         */
+        StacklessPreOrderIterator(NodeType* root) : root(root), current(root) {}
+
+        /**
+         * @brief Inequality operator to compare two iterators.
+         * 
+         * @param other The other iterator to compare to.
+         * @return true If the iterators are not equal.
+         * @return false If the iterators are equal.
+         */
+        bool operator!=(const StacklessPreOrderIterator& other) const {
+            return current != nullptr;
+        }
+
+        /**
+         * @brief Increment the iterator.
+         * 
+         * @return StacklessPreOrderIterator& Reference to the incremented iterator.
+         */
+        StacklessPreOrderIterator& operator++() {
+            if (!current->children.empty()) {
+                current = current->children[0];
+                return *this;
+            }
+            while (current != root) {
+                NodeType* parent = current->parent;
+                std::size_t next = current->child_index + 1;
+                if (next < parent->children.size()) {
+                    current = parent->children[next];
+                    return *this;
+                }
+                current = parent;
+            }
+            current = nullptr;
+            return *this;
+        }
+
+        /**
+         * @brief Dereference operator to access the current node.
+         * 
+         * @return NodeType& Reference to the current node.
+         */
+        NodeType& operator*() const {
+            return *current;
+        }
+
+        /**
+         * @brief Arrow operator to access the current node.
+         * 
+         * @return NodeType* Pointer to the current node.
+         */
+        NodeType* operator->() const {
+            return current;
+        }
+
+    private:
+        NodeType* root;    ///< The node where the traversal starts and ends.
+        NodeType* current; ///< The current node, or nullptr at the end.
+    };
+
+    /**
+     * @brief Get an iterator to the beginning of the stackless pre-order traversal.
+     * 
+     * @return StacklessPreOrderIterator An iterator to the beginning of the traversal.
+     */
+    StacklessPreOrderIterator begin_stackless_pre_order() const {
+        return StacklessPreOrderIterator(root);
+    }
+
+    /**
+     * @brief Get an iterator to the end of the stackless pre-order traversal.
+     * 
+     * @return StacklessPreOrderIterator An iterator to the end of the traversal.
+     */
+    StacklessPreOrderIterator end_stackless_pre_order() const {
+        return StacklessPreOrderIterator(nullptr);
+    }
+
+    /**
+     * @class StacklessPostOrderIterator
+     * @brief A post-order iterator that uses parent links instead of a stack.
+     * 
+     * Only available for node types with parent links, such as ParentNode. The iterator takes
+     * O(1) memory and never allocates.
+     */
+    class StacklessPostOrderIterator {
+    public:
+        /**
+         * @brief Construct a new StacklessPostOrderIterator object.
+         * 
+         * @param root The root node of the tree.
+         */
+        StacklessPostOrderIterator(NodeType* root) : root(root), current(leftmost_leaf(root)) {}
+
+        /**
+         * @brief Inequality operator to compare two iterators.
+         * 
+         * @param other The other iterator to compare to.
+         * @return true If the iterators are not equal.
+         * @return false If the iterators are equal.
+         */
+        bool operator!=(const StacklessPostOrderIterator& other) const {
+            return current != nullptr;
+        }
+
+        /**
+         * @brief Increment the iterator.
+         * 
+         * @return StacklessPostOrderIterator& Reference to the incremented iterator.
+         */
+        StacklessPostOrderIterator& operator++() {
+            if (current == root) {
+                current = nullptr;
+                return *this;
+            }
+            NodeType* parent = current->parent;
+            std::size_t next = current->child_index + 1;
+            current = next < parent->children.size() ? leftmost_leaf(parent->children[next]) : parent;
+            return *this;
+        }
+
+        /**
+         * @brief Dereference operator to access the current node.
+         * 
+         * @return NodeType& Reference to the current node.
+         */
+        NodeType& operator*() const {
+            return *current;
+        }
+
+        /**
+         * @brief Arrow operator to access the current node.
+         * 
+         * @return NodeType* Pointer to the current node.
+         */
+        NodeType* operator->() const {
+            return current;
+        }
+
+    private:
+        NodeType* root;    ///< The node where the traversal ends.
+        NodeType* current; ///< The current node, or nullptr at the end.
+
+        /**
+         * @brief Follow first children down to a leaf.
+         * 
+         * @param node The starting node.
+         * @return NodeType* The leaf reached, or nullptr if the node is null.
+         */
+        static NodeType* leftmost_leaf(NodeType* node) {
+            while (node && !node->children.empty()) {
+                node = node->children[0];
+            }
+            return node;
+        }
+    };
+
+    /**
+     * @brief Get an iterator to the beginning of the stackless post-order traversal.
+     * 
+     * @return StacklessPostOrderIterator An iterator to the beginning of the traversal.
+     */
+    StacklessPostOrderIterator begin_stackless_post_order() const {
+        return StacklessPostOrderIterator(root);
+    }
+
+    /**
+     * @brief Get an iterator to the end of the stackless post-order traversal.
+     * 
+     * @return StacklessPostOrderIterator An iterator to the end of the traversal.
+     */
+    StacklessPostOrderIterator end_stackless_post_order() const {
+        return StacklessPostOrderIterator(nullptr);
+    }
+
+    /**
+     * @brief Check whether every parent key is no greater than its children's keys.
+     * 
+     * @return true If the tree is heap-ordered, so the frontier traversal is sorted.
+     * @return false Otherwise.
+     */
+    bool is_heap_ordered() const {
+        if (!root) return true;
+        std::vector<NodeType*> pending(1, root);
+        while (!pending.empty()) {
+            NodeType* node = pending.back();
+            pending.pop_back();
+            for (auto child : node->children) {
+                if (child->get_key() < node->get_key()) return false;
+                pending.push_back(child);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the m nodes with the smallest keys, in ascending key order.
+     * 
+     * Works on any tree in one pass with a bounded max-heap of m candidates, so it takes
+     * O(n log m) time and O(m) memory beyond the walk itself. For heap-ordered trees the
+     * frontier traversal gives the same answer without visiting the whole tree.
+     * 
+     * @param m The number of nodes to return.
+     * @return std::vector<NodeType*> Up to m nodes sorted by key.
+     */
+    std::vector<NodeType*> smallest(std::size_t m) const {
+        std::vector<NodeType*> best;
+        if (!root || m == 0) return best;
+        best.reserve(m);
+        std::vector<NodeType*> pending(1, root);
+        while (!pending.empty()) {
+            NodeType* node = pending.back();
+            pending.pop_back();
+            if (best.size() < m) {
+                best.push_back(node);
+                std::push_heap(best.begin(), best.end(), key_less);
+            } else if (node->get_key() < best.front()->get_key()) {
+                std::pop_heap(best.begin(), best.end(), key_less);
+                best.back() = node;
+                std::push_heap(best.begin(), best.end(), key_less);
+            }
+            for (auto child : node->children) {
+                pending.push_back(child);
+            }
+        }
+        std::sort_heap(best.begin(), best.end(), key_less);
+        return best;
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the BFS traversal.
+     * 
+     * This is the default traversal method.
+     * 
+     * @return BFSIterator An iterator to the beginning of the BFS traversal.
+     */
+    BFSIterator begin() const {
+        return begin_bfs();
+    }
+
+    /**
+     * @brief Get an iterator to the end of the BFS traversal.
+     * 
+     * This is the default traversal method.
+     * 
+     * @return BFSIterator An iterator to the end of the BFS traversal.
+     */
+    BFSIterator end() const {
+        return end_bfs();
+    }
+
+    /**
+     * @brief Write the tree as indented text, one key per line in pre-order.
+     * 
+     * Each line holds two spaces per level of depth followed by the key as printed by
+     * operator<<. The walk is iterative, so tree depth is not limited by the call stack, and the
+     * text is formatted into a large block that is handed to the stream one block at a time.
+     * On a stream with default formatting, keys are converted with format_key.
+     * 
+     * @param os The output stream; its formatting flags are used for the keys.
+     */
+    void write_text(std::ostream& os) const {
+        if (!root) return;
+        BlockWriter block(os);
+        std::ostream out(&block);
+        out.copyfmt(os);
+        out.tie(nullptr);
+        bool plain = os.flags() == (std::ios_base::dec | std::ios_base::skipws) && os.precision() == 6 &&
+                     os.width() == 0 && os.getloc() == std::locale::classic();
+        char key_text[64];
+        std::vector<NodeType*> stack(1, root);
+        std::vector<std::size_t> depths(1, 0);
+        while (!stack.empty()) {
+            NodeType* node = stack.back();
+            std::size_t depth = depths.back();
+            stack.pop_back();
+            depths.pop_back();
+            block.spaces(2 * depth);
+            char* key_end = plain ? format_key(key_text, key_text + sizeof(key_text), node->get_key()) : nullptr;
+            if (key_end) {
+                block.sputn(key_text, key_end - key_text);
+            } else {
+                out << node->get_key();
+            }
+            block.put('\n');
+            push_children_reversed(stack, node);
+            depths.resize(stack.size(), depth + 1);
+        }
+        block.flush();
+    }
+
+    /**
+     * @brief Read a tree written by write_text or operator<<.
+     * 
+     * Each non-blank line must be indented by two spaces per level and at most one level
+     * deeper than the line before it; the key is read from the rest of the line with
+     * operator>>, except that a std::string key is the rest of the line as it stands, spaces
+     * included. String keys that are empty, start with a space or hold a newline therefore do
+     * not survive a round trip. Nodes are created in the tree's arena and linked as their lines
+     * arrive, with no key lookups; the new tree replaces the current root only once the whole
+     * input has been read.
+     * 
+     * @param in The input stream, read to its end.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If the input is empty, a line is badly indented or holds
+     * no key, there is more than one root, or a node would get more than k children; the tree
+     * is then left unchanged.
+     */
+    NodeType& read_text(std::istream& in) {
+        LineReader lines(in);
+        std::vector<NodeType*> path;
+        std::string text;
+        std::istringstream parser;
+        NodeType* first_root = nullptr;
+        const char* first;
+        const char* last;
+        while (lines.next(first, last)) {
+            const char* key_start = first;
+            while (key_start != last && *key_start == ' ') ++key_start;
+            if (key_start == last) continue;
+            std::size_t indent = static_cast<std::size_t>(key_start - first);
+            if (indent % 2 != 0 || indent / 2 > path.size()) text_error(lines, "is badly indented");
+            std::size_t depth = indent / 2;
+            if (depth == 0 && first_root) text_error(lines, "starts a second root");
+
+            T key;
+            if (!parse_text_key(key_start, last, text, parser, key, std::is_same<T, std::string>())) {
+                text_error(lines, "does not hold a key");
+            }
+
+            NodeType* parent = depth > 0 ? path[depth - 1] : nullptr;
+            if (parent && parent->children.size() >= static_cast<std::size_t>(k)) {
+                text_error(lines, "gives a node more than k children");
+            }
+            NodeType* node = node_arena().create(key);
+            if (parent) {
+                parent->add_child(node);
+            } else {
+                first_root = node;
+            }
+            path.resize(depth);
+            path.push_back(node);
+        }
+        if (!first_root) throw std::invalid_argument("text read: no nodes");
+        add_root(*first_root);
+        return *first_root;
+    }
 
     /**
      * @brief Overload the stream insertion operator to print the tree.
@@ -641,31 +1783,479 @@ public:
      * @param os The output stream.
      * @param tree The tree to print.
      * @return std::ostream& The output stream.
+     * @see write_text
      */
-    friend std::ostream& operator<<(std::ostream& os, const Tree<T, k>& tree) {
-        if (tree.root) {
-            tree.print_node(os, tree.root, 0);
-        }
+    friend std::ostream& operator<<(std::ostream& os, const Tree& tree) {
+        tree.write_text(os);
         return os;
     }
 
 private:
     /**
-     * @brief Print the node and its children recursively.
+     * @class ParallelWalk
+     * @brief The state of one parallel_for_each call.
+     */
+    template <typename F>
+    class ParallelWalk {
+    public:
+        ParallelWalk(bool post, F& fn, WorkStealingPool& pool) : post(post), fn(fn), group(pool) {}
+
+        /**
+         * @brief Walk the subtree of the given node and wait for the walk to finish.
+         * 
+         * @param root The root of the walk.
+         */
+        void run(NodeType* root) {
+            group.run([this, root]() { walk(root, nullptr); });
+            group.wait();
+        }
+
+    private:
+        /**
+         * @brief A node whose children were split into separate tasks.
+         */
+        struct Join {
+            std::atomic<std::size_t> remaining; ///< Child subtrees not yet finished.
+            NodeType* node;                     ///< The node.
+            Join* parent;                       ///< The nearest split ancestor, or nullptr.
+        };
+
+        bool post;       ///< Visit nodes after rather than before their descendants.
+        F& fn;           ///< The function to call on every node.
+        TaskGroup group; ///< The tasks of the walk.
+
+        /**
+         * @brief Walk a subtree, splitting it across tasks if the pool needs work.
+         * 
+         * @param node The root of the subtree.
+         * @param up The join to signal once the subtree is done.
+         */
+        void walk(NodeType* node, Join* up) {
+            std::size_t count = node->children.size();
+            WorkStealingPool& pool = group.executor();
+            if (count > 1 && pool.pending() < 2 * pool.size()) {
+                if (!post) visit(*node);
+                Join* join;
+                try {
+                    join = new Join;
+                } catch (...) {
+                    group.fail(std::current_exception());
+                    finish(up);
+                    return;
+                }
+                join->remaining = count;
+                join->node = node;
+                join->parent = up;
+                std::size_t queued = 0;
+                try {
+                    for (auto child : node->children) {
+                        group.run([this, child, join]() { walk(child, join); });
+                        ++queued;
+                    }
+                } catch (...) {
+                    // Children that could not be queued count as done, so the join still completes
+                    group.fail(std::current_exception());
+                    finish(join, count - queued);
+                }
+                return;
+            }
+            try {
+                if (post) {
+                    for (PostOrderIterator it(node); it != PostOrderIterator(nullptr); ++it) fn(*it);
+                } else {
+                    for (PreOrderIterator it(node); it != PreOrderIterator(nullptr); ++it) fn(*it);
+                }
+            } catch (...) {
+                group.fail(std::current_exception());
+            }
+            finish(up);
+        }
+
+        /**
+         * @brief Signal that child subtrees of a join are done, completing joins as they empty.
+         * 
+         * @param join The join to signal.
+         * @param done The number of child subtrees that are done.
+         */
+        void finish(Join* join, std::size_t done = 1) {
+            for (; join && join->remaining.fetch_sub(done) == done; done = 1) {
+                if (post) visit(*join->node);
+                Join* up = join->parent;
+                delete join;
+                join = up;
+            }
+        }
+
+        /**
+         * @brief Call the function on one node, recording any exception.
+         * 
+         * @param node The node.
+         */
+        void visit(NodeType& node) {
+            try {
+                fn(node);
+            } catch (...) {
+                group.fail(std::current_exception());
+            }
+        }
+    };
+
+private:
+    /**
+     * @class ParallelReduce
+     * @brief The state of one transform_reduce call.
+     */
+    template <typename R, typename Op, typename Tx>
+    class ParallelReduce {
+    public:
+        ParallelReduce(Op& op, Tx& transform, WorkStealingPool& pool) : op(op), transform(transform), group(pool) {}
+
+        /**
+         * @brief Reduce the subtree of the given node and wait for the result.
+         * 
+         * @param root The root of the reduction.
+         * @param placeholder A value used to initialize result slots before they are written.
+         * @return R The result for the subtree.
+         */
+        R run(NodeType* root, const R& placeholder) {
+            R result = placeholder;
+            group.run([this, root, &result]() { reduce(root, nullptr, &result); });
+            group.wait();
+            return result;
+        }
+
+    private:
+        /**
+         * @brief A node whose child subtrees are reduced by separate tasks.
+         */
+        struct Join {
+            std::atomic<std::size_t> remaining; ///< Child subtrees not yet finished.
+            NodeType* node;                     ///< The node.
+            std::vector<R> slots;               ///< Child subtree results, in child order.
+            Join* parent;                       ///< The join to deliver the result to.
+            R* out;                             ///< The slot to deliver the result to.
+        };
+
+        /**
+         * @brief A node on the path of a sequential reduction.
+         */
+        struct Frame {
+            NodeType* node;  ///< The node.
+            typename NodeType::children_type::iterator next; ///< The next child to reduce.
+            R acc;           ///< The node's result so far.
+        };
+
+        Op& op;          ///< The binary operation.
+        Tx& transform;   ///< The key transformation.
+        TaskGroup group; ///< The tasks of the reduction.
+
+        /**
+         * @brief Reduce a subtree, splitting it across tasks if the pool needs work.
+         * 
+         * @param node The root of the subtree.
+         * @param up The join to signal once the result is written, or nullptr.
+         * @param out Where to write the subtree result.
+         */
+        void reduce(NodeType* node, Join* up, R* out) {
+            std::size_t count = node->children.size();
+            WorkStealingPool& pool = group.executor();
+            if (count > 1 && pool.pending() < 2 * pool.size()) {
+                Join* join;
+                try {
+                    join = new Join{{count}, node, std::vector<R>(count, *out), up, out};
+                } catch (...) {
+                    group.fail(std::current_exception());
+                    finish(up);
+                    return;
+                }
+                std::size_t queued = 0;
+                try {
+                    for (auto child : node->children) {
+                        R* slot = &join->slots[queued];
+                        group.run([this, child, join, slot]() { reduce(child, join, slot); });
+                        ++queued;
+                    }
+                } catch (...) {
+                    // Children that could not be queued count as done, so the join still completes
+                    group.fail(std::current_exception());
+                    finish(join, count - queued);
+                }
+                return;
+            }
+            try {
+                *out = reduce_sequential(node);
+            } catch (...) {
+                group.fail(std::current_exception());
+            }
+            finish(up);
+        }
+
+        /**
+         * @brief Reduce a subtree on the calling thread.
+         * 
+         * @param node The root of the subtree.
+         * @return R The subtree result.
+         */
+        R reduce_sequential(NodeType* node) {
+            std::vector<Frame> stack;
+            stack.push_back(Frame{node, node->children.begin(), transform(node->get_key())});
+            while (true) {
+                Frame& top = stack.back();
+                if (top.next != top.node->children.end()) {
+                    NodeType* child = *top.next;
+                    ++top.next;
+                    stack.push_back(Frame{child, child->children.begin(), transform(child->get_key())});
+                    continue;
+                }
+                if (stack.size() == 1) return top.acc;
+                R done = top.acc;
+                stack.pop_back();
+                stack.back().acc = op(stack.back().acc, done);
+            }
+        }
+
+        /**
+         * @brief Signal that child subtrees of a join are done, completing joins as they empty.
+         * 
+         * @param join The join to signal.
+         * @param done The number of child subtrees that are done.
+         */
+        void finish(Join* join, std::size_t done = 1) {
+            for (; join && join->remaining.fetch_sub(done) == done; done = 1) {
+                try {
+                    R acc = transform(join->node->get_key());
+                    for (auto& slot : join->slots) acc = op(acc, slot);
+                    *join->out = acc;
+                } catch (...) {
+                    group.fail(std::current_exception());
+                }
+                Join* up = join->parent;
+                delete join;
+                join = up;
+            }
+        }
+    };
+
+    /**
+     * @brief Create and link the nodes of a tree given in compressed child-list form.
      * 
-     * @param os The output stream.
-     * @param node The current node.
-     * @param depth The current depth for indentation.
+     * @param keys The key of every node.
+     * @param root_index The index of the root, or keys.size() if there is none.
+     * @param offsets Child-list offsets: the children of node i are
+     * children[offsets[i]] up to children[offsets[i + 1] - 1].
+     * @param children The concatenated child lists.
+     * @return NodeType& The new root.
+     * @throws std::invalid_argument If there is no root, a node has more than k children, or
+     * some node is not reachable from the root.
      */
-    void print_node(std::ostream& os, Node<T>* node, int depth) const {
-        for (int i = 0; i < depth; ++i) {
-            os << "  ";
+    NodeType& build_linked(const std::vector<T>& keys, std::size_t root_index,
+                           const std::vector<std::size_t>& offsets, const std::vector<std::size_t>& children) {
+        std::size_t n = keys.size();
+        if (root_index >= n) throw std::invalid_argument("tree build: no root");
+        for (std::size_t i = 0; i < n; ++i) {
+            if (offsets[i + 1] - offsets[i] > static_cast<std::size_t>(k)) {
+                throw std::invalid_argument("tree build: node " + std::to_string(i) + " has more than k children");
+            }
         }
-        os << node->get_key() << "\n";
-        for (auto& child : node->children) {
-            print_node(os, child, depth + 1);
+        std::vector<std::size_t> order;
+        order.reserve(n);
+        order.push_back(root_index);
+        for (std::size_t j = 0; j < order.size(); ++j) {
+            for (std::size_t c = offsets[order[j]]; c < offsets[order[j] + 1]; ++c) {
+                order.push_back(children[c]);
+            }
+        }
+        if (order.size() != n) throw std::invalid_argument("tree build: the parent links form a cycle");
+
+        NodeArena<NodeType>& nodes = node_arena();
+        nodes.reserve(n);
+        std::vector<NodeType*> created(n, nullptr);
+        for (std::size_t j = 0; j < n; ++j) {
+            std::size_t i = order[j];
+            created[i] = nodes.create(keys[i]);
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            std::size_t i = order[j];
+            reserve_children(created[i]->children, offsets[i + 1] - offsets[i]);
+            for (std::size_t c = offsets[i]; c < offsets[i + 1]; ++c) {
+                created[i]->add_child(created[children[c]]);
+            }
+        }
+        add_root(*created[root_index]);
+        return *created[root_index];
+    }
+
+    /**
+     * @brief Reserve room in a std::vector child list.
+     * 
+     * @param children The child list.
+     * @param count The number of children about to be added.
+     */
+    template <typename P>
+    static void reserve_children(std::vector<P>& children, std::size_t count) {
+        children.reserve(count);
+    }
+
+    /**
+     * @brief Reserving is a no-op for child lists without heap storage.
+     */
+    template <typename C>
+    static void reserve_children(C&, std::size_t) {}
+
+    /**
+     * @brief Compare two nodes by key.
+     * 
+     * @param a Pointer to the first node.
+     * @param b Pointer to the second node.
+     * @return true If the first node's key is less than the second node's key.
+     * @return false Otherwise.
+     */
+    static bool key_less(NodeType* a, NodeType* b) {
+        return a->get_key() < b->get_key();
+    }
+
+    /**
+     * @brief Push the children of a node onto a stack so that the first child ends up on top.
+     * 
+     * Children are read front to back, so this works for node types whose child list cannot
+     * be walked backwards.
+     * 
+     * @param stack The stack to push onto.
+     * @param node The node whose children are pushed.
+     */
+    static void push_children_reversed(std::vector<NodeType*>& stack, NodeType* node) {
+        std::size_t mark = stack.size();
+        for (auto child : node->children) {
+            stack.push_back(child);
+        }
+        std::reverse(stack.begin() + mark, stack.end());
+    }
+
+    /**
+     * @brief Get the node arena, creating it on first use.
+     * 
+     * @return NodeArena<NodeType>& The arena holding tree-owned nodes.
+     */
+    NodeArena<NodeType>& node_arena() {
+        if (!arena) arena = std::make_shared<NodeArena<NodeType> >();
+        return *arena;
+    }
+
+    /**
+     * @brief Report a malformed line of tree text.
+     * 
+     * @param lines The reader, positioned just after the offending line.
+     * @param problem What is wrong with the line.
+     * @throws std::invalid_argument Always.
+     */
+    static void text_error(const LineReader& lines, const char* problem) {
+        throw std::invalid_argument("text read: line " + std::to_string(lines.lines()) + " " + problem);
+    }
+
+    /**
+     * @brief Parse the key of a text line with operator>>, which must use up the whole text.
+     * 
+     * @param first The start of the key text.
+     * @param last The end of the key text.
+     * @param text Reused string holding the key text.
+     * @param parser Reused stream reading the key text.
+     * @param key Receives the key.
+     * @return true If the text holds exactly one key.
+     * @return false Otherwise.
+     */
+    static bool parse_text_key(const char* first, const char* last, std::string& text, std::istringstream& parser,
+                               T& key, std::false_type) {
+        text.assign(first, last);
+        parser.clear();
+        parser.str(text);
+        return (parser >> key) && (parser >> std::ws).eof();
+    }
+
+    /**
+     * @brief Take a whole text line, spaces included, as a std::string key.
+     * 
+     * @param first The start of the key text.
+     * @param last The end of the key text.
+     * @param key Receives the key.
+     * @return true Always.
+     */
+    static bool parse_text_key(const char* first, const char* last, std::string&, std::istringstream&,
+                               T& key, std::true_type) {
+        key.assign(first, last);
+        return true;
+    }
+
+    /**
+     * @brief Search a subtree in pre-order for a node with the target's key.
+     * 
+     * The visits are counted locally and added to the counters once, when the search ends.
+     * 
+     * @param current The root of the subtree to search.
+     * @param target The target node to find.
+     * @param pending The search stack, empty on entry.
+     * @return NodeType* Pointer to the first match in pre-order, or nullptr if not found.
+     */
+    NodeType* search(NodeType* current, NodeType& target, std::vector<NodeType*>& pending) {
+        if (!current) return nullptr;
+        std::uint64_t visits = 0;
+        NodeType* found = nullptr;
+        pending.push_back(current);
+        while (!pending.empty()) {
+            NodeType* node = pending.back();
+            pending.pop_back();
+            ++visits;
+            if (node->get_key() == target.get_key()) {
+                found = node;
+                break;
+            }
+            push_children_reversed(pending, node);
+        }
+        counters().count_find_visits(visits);
+        return found;
+    }
+
+    /**
+     * @brief Register a node and all of its descendants in the key index.
+     * 
+     * @param node The root of the subtree to index.
+     */
+    void index_subtree(NodeType* node) {
+        if (!node) return;
+        std::vector<NodeType*> pending(1, node);
+        while (!pending.empty()) {
+            NodeType* current = pending.back();
+            pending.pop_back();
+            index->insert(current);
+            push_children_reversed(pending, current);
         }
     }
 };
 
+/**
+ * @brief A k-ary tree whose nodes store up to k child pointers inline.
+ * 
+ * @tparam T The type of the key stored in the nodes.
+ * @tparam k The maximum number of children per node.
+ */
+template <typename T, int k = 2>
+using InlineTree = Tree<T, k, Node<T, k> >;
+
+/**
+ * @brief A k-ary tree whose nodes use the first-child/next-sibling layout.
+ * 
+ * @tparam T The type of the key stored in the nodes.
+ * @tparam k The maximum number of children per node.
+ */
+template <typename T, int k = 2>
+using SiblingTree = Tree<T, k, SiblingNode<T> >;
+
+/**
+ * @brief A k-ary tree whose nodes link back to their parents.
+ * 
+ * @tparam T The type of the key stored in the nodes.
+ * @tparam k The maximum number of children per node.
+ */
+template <typename T, int k = 2>
+using ParentTree = Tree<T, k, ParentNode<T> >;
+
 #endif // TREE_HPP
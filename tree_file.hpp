@@ -0,0 +1,350 @@
+/**
+ * @file tree_file.hpp
+ * @brief Declaration of the binary tree file format, its writer, and the MappedTree loader.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains a compact on-disk format for trees and a loader that memory-maps the file
+ * and traverses it in place. A file holds a fixed 40-byte header followed by the two arrays of
+ * a FrozenTree:
+ *
+ *     offset  size  field
+ *          0     8  magic "KTREE\0\0\0"
+ *          8     4  format version (1)
+ *         12     4  byte-order mark 0x01020304, written in the writer's byte order
+ *         16     4  k, the fan-out limit of the tree
+ *         20     4  key type tag (see TreeFileKey)
+ *         24     4  sizeof the key type
+ *         28     4  reserved, 0
+ *         32     8  node count n
+ *         40  n*sz  keys in breadth-first order, padded with zeros to a multiple of 8 bytes
+ *          .  4n+4  uint32 first-child offsets, one per node plus a final entry n
+ *
+ * Keys are stored as raw bytes, so only trivially copyable key types with a TreeFileKey tag
+ * can be written, and files are read back only on machines with the same byte order.
+ * Loading validates the header and the file size, which takes constant time; the offsets are
+ * trusted unless MappedTree::validate is called.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef TREE_FILE_HPP
+#define TREE_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "complex.hpp"
+#include "frozen_tree.hpp"
+
+/**
+ * @brief Key type tags stored in tree files; each supported key type specializes it.
+ *
+ * @tparam T The key type.
+ */
+template <typename T>
+struct TreeFileKey;
+
+template <> struct TreeFileKey<std::int8_t> { static const std::uint32_t tag = 1; };
+template <> struct TreeFileKey<std::uint8_t> { static const std::uint32_t tag = 2; };
+template <> struct TreeFileKey<std::int16_t> { static const std::uint32_t tag = 3; };
+template <> struct TreeFileKey<std::uint16_t> { static const std::uint32_t tag = 4; };
+template <> struct TreeFileKey<std::int32_t> { static const std::uint32_t tag = 5; };
+template <> struct TreeFileKey<std::uint32_t> { static const std::uint32_t tag = 6; };
+template <> struct TreeFileKey<std::int64_t> { static const std::uint32_t tag = 7; };
+template <> struct TreeFileKey<std::uint64_t> { static const std::uint32_t tag = 8; };
+template <> struct TreeFileKey<float> { static const std::uint32_t tag = 9; };
+template <> struct TreeFileKey<double> { static const std::uint32_t tag = 10; };
+template <> struct TreeFileKey<Complex> { static const std::uint32_t tag = 11; };
+
+/**
+ * @brief The fixed-size header at the start of every tree file.
+ */
+struct TreeFileHeader {
+    static const std::uint32_t VERSION = 1;             ///< Current format version.
+    static const std::uint32_t ORDER_MARK = 0x01020304; ///< Byte-order mark.
+
+    char magic[8];            ///< "KTREE" padded with zeros.
+    std::uint32_t version;    ///< Format version.
+    std::uint32_t byte_order; ///< ORDER_MARK in the writer's byte order.
+    std::uint32_t arity;      ///< Fan-out limit k.
+    std::uint32_t key_tag;    ///< TreeFileKey tag of the key type.
+    std::uint32_t key_size;   ///< Size of one key in bytes.
+    std::uint32_t reserved;   ///< Always 0.
+    std::uint64_t node_count; ///< Number of nodes.
+
+    /**
+     * @brief Get the offset of the offset array from the start of the file.
+     *
+     * @return std::size_t The byte offset.
+     */
+    std::size_t offsets_position() const {
+        return sizeof(TreeFileHeader) + padded(static_cast<std::size_t>(node_count) * key_size);
+    }
+
+    /**
+     * @brief Get the total file size implied by the header.
+     *
+     * @return std::size_t The file size in bytes.
+     */
+    std::size_t file_size() const {
+        return offsets_position() + (static_cast<std::size_t>(node_count) + 1) * sizeof(std::uint32_t);
+    }
+
+    /**
+     * @brief Round a byte count up to a multiple of 8.
+     *
+     * @param bytes The byte count.
+     * @return std::size_t The padded byte count.
+     */
+    static std::size_t padded(std::size_t bytes) { return (bytes + 7) / 8 * 8; }
+};
+
+static_assert(sizeof(TreeFileHeader) == 40, "the tree file header must be 40 bytes");
+
+/**
+ * @brief Write a snapshot in the binary tree file format.
+ *
+ * @param out The output stream, opened in binary mode.
+ * @param tree The snapshot to write.
+ * @throws std::runtime_error If writing fails.
+ */
+template <typename T>
+void write_tree_file(std::ostream& out, const FrozenTree<T>& tree) {
+    static_assert(std::is_trivially_copyable<T>::value, "tree files store keys as raw bytes");
+    TreeFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "KTREE", 5);
+    header.version = TreeFileHeader::VERSION;
+    header.byte_order = TreeFileHeader::ORDER_MARK;
+    header.arity = static_cast<std::uint32_t>(tree.max_children());
+    header.key_tag = TreeFileKey<T>::tag;
+    header.key_size = sizeof(T);
+    header.node_count = tree.size();
+
+    static const char zeros[8] = {0};
+    std::size_t key_bytes = tree.size() * sizeof(T);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (key_bytes > 0) out.write(reinterpret_cast<const char*>(tree.keys().data()), key_bytes);
+    out.write(zeros, TreeFileHeader::padded(key_bytes) - key_bytes);
+    out.write(reinterpret_cast<const char*>(tree.child_offsets().data()),
+              tree.child_offsets().size() * sizeof(std::uint32_t));
+    if (!out) throw std::runtime_error("tree file: write failed");
+}
+
+/**
+ * @brief Write a snapshot to a file in the binary tree file format.
+ *
+ * @param path The file path; an existing file is replaced.
+ * @param tree The snapshot to write.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+template <typename T>
+void save_tree_file(const std::string& path, const FrozenTree<T>& tree) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("tree file: cannot open " + path);
+    write_tree_file(out, tree);
+    out.close();
+    if (!out) throw std::runtime_error("tree file: write failed for " + path);
+}
+
+/**
+ * @class MappedTree
+ * @brief A read-only tree backed by a memory-mapped tree file.
+ *
+ * Opening a file maps it and checks the header; keys and offsets are then read straight from
+ * the mapping, so no node is deserialized and pages are loaded only when a traversal touches
+ * them.
+ *
+ * @tparam T The type of the key stored in the nodes.
+ */
+template <typename T>
+class MappedTree {
+public:
+    typedef typename FlatTreeView<T>::index_type index_type; ///< Type of node indices and child offsets.
+
+    /**
+     * @brief Map a tree file.
+     *
+     * @param path The file path.
+     * @throws std::runtime_error If the file cannot be mapped or is not a tree file with keys
+     * of type T and this machine's byte order.
+     */
+    explicit MappedTree(const std::string& path) : data(nullptr), length(0) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("tree file: cannot open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("tree file: cannot stat " + path);
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        if (length < sizeof(TreeFileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("tree file: " + path + " is too short");
+        }
+        data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+            throw std::runtime_error("tree file: cannot map " + path);
+        }
+        try {
+            open_view(path);
+        } catch (...) {
+            ::munmap(data, length);
+            throw;
+        }
+    }
+
+    MappedTree(const MappedTree&) = delete;
+    MappedTree& operator=(const MappedTree&) = delete;
+
+    /**
+     * @brief Take over another mapping.
+     *
+     * @param other The tree to move from; it is left empty.
+     */
+    MappedTree(MappedTree&& other) : data(other.data), length(other.length), flat(other.flat) {
+        other.data = nullptr;
+        other.length = 0;
+        other.flat = FlatTreeView<T>();
+    }
+
+    /**
+     * @brief Unmap the file.
+     */
+    ~MappedTree() {
+        if (data) ::munmap(data, length);
+    }
+
+    /**
+     * @brief Get a view of the mapped arrays.
+     *
+     * @return const FlatTreeView<T>& The view, valid while this object is alive.
+     */
+    const FlatTreeView<T>& view() const { return flat; }
+
+    /**
+     * @brief Get the number of nodes.
+     *
+     * @return std::size_t The number of nodes.
+     */
+    std::size_t size() const { return flat.size(); }
+
+    /**
+     * @brief Check whether the tree has no nodes.
+     *
+     * @return true If the tree is empty.
+     * @return false Otherwise.
+     */
+    bool empty() const { return flat.empty(); }
+
+    /**
+     * @brief Get the fan-out limit stored in the file.
+     *
+     * @return int The maximum number of children per node.
+     */
+    int max_children() const { return flat.max_children(); }
+
+    /**
+     * @brief Get the key of a node.
+     *
+     * @param i The node index; the root is node 0.
+     * @return const T& The key of the node.
+     */
+    const T& key(std::size_t i) const { return flat.key(i); }
+
+    /**
+     * @brief Get the index of a node's first child.
+     *
+     * @param i The node index.
+     * @return std::size_t The index of the first child, meaningful only if the node has children.
+     */
+    std::size_t first_child(std::size_t i) const { return flat.first_child(i); }
+
+    /**
+     * @brief Get the number of children of a node.
+     *
+     * @param i The node index.
+     * @return std::size_t The number of children.
+     */
+    std::size_t child_count(std::size_t i) const { return flat.child_count(i); }
+
+    /**
+     * @brief Call a function on every key in the given traversal order.
+     *
+     * @param order The traversal order.
+     * @param fn The function, called as fn(key).
+     */
+    template <typename F>
+    void for_each(Traversal order, F fn) const {
+        flat.for_each(order, fn);
+    }
+
+    /**
+     * @brief Check that the offsets describe a breadth-first tree within the fan-out limit.
+     *
+     * Reads the whole offset array, so it costs O(n) and touches every offset page.
+     *
+     * @return true If every traversal stays inside the mapped arrays.
+     * @return false If the offsets are corrupt.
+     */
+    bool validate() const {
+        std::size_t n = flat.size();
+        const index_type* offsets = flat.child_offsets();
+        if (n == 0) return offsets[0] == 0;
+        if (offsets[0] != 1 || offsets[n] != n) return false;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (offsets[i] < i + 1 || offsets[i + 1] < offsets[i]) return false;
+            if (offsets[i + 1] - offsets[i] > static_cast<std::size_t>(flat.max_children())) return false;
+        }
+        return true;
+    }
+
+private:
+    void* data;           ///< Start of the mapping.
+    std::size_t length;   ///< Length of the mapping in bytes.
+    FlatTreeView<T> flat; ///< View of the mapped arrays.
+
+    /**
+     * @brief Check the header and set up the view.
+     *
+     * @param path The file path, for error messages.
+     * @throws std::runtime_error If the header does not match T or the file size.
+     */
+    void open_view(const std::string& path) {
+        const char* bytes = static_cast<const char*>(data);
+        TreeFileHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, "KTREE\0\0\0", 8) != 0) {
+            throw std::runtime_error("tree file: " + path + " is not a tree file");
+        }
+        if (header.version != TreeFileHeader::VERSION) {
+            throw std::runtime_error("tree file: " + path + " has unsupported version " + std::to_string(header.version));
+        }
+        if (header.byte_order != TreeFileHeader::ORDER_MARK) {
+            throw std::runtime_error("tree file: " + path + " was written with a different byte order");
+        }
+        if (header.key_tag != TreeFileKey<T>::tag || header.key_size != sizeof(T)) {
+            throw std::runtime_error("tree file: " + path + " holds a different key type");
+        }
+        if (header.node_count > 0xffffffffULL || header.file_size() != length) {
+            throw std::runtime_error("tree file: " + path + " has the wrong size");
+        }
+        flat = FlatTreeView<T>(static_cast<int>(header.arity), static_cast<std::size_t>(header.node_count),
+                               reinterpret_cast<const T*>(bytes + sizeof(TreeFileHeader)),
+                               reinterpret_cast<const index_type*>(bytes + header.offsets_position()));
+    }
+};
+
+#endif // TREE_FILE_HPP
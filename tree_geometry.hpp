@@ -0,0 +1,346 @@
+/**
+ * @file tree_geometry.hpp
+ * @brief Declaration of the TreeGeometry class, batched vertex data for drawing a laid-out tree.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the declaration of the TreeGeometry class, which turns a TreeLayout into
+ * three flat vertex batches: line segments for the edges, one textured quad per node disc, and
+ * one textured quad per label glyph. Discs are quads over a disc texture rather than triangle
+ * fans, which keeps them at six vertices per node. A renderer copies each batch into one vertex
+ * array and draws the whole tree with three draw calls. The batches are rebuilt only when the
+ * layout's version or the viewport changes, and glyph metrics are fetched once per character
+ * and cached. Given a viewport, only the nodes that can be seen are batched: subtrees outside
+ * the view are skipped, subtrees narrower than a pixel become one solid aggregate quad, and
+ * labels are left out once they are too small to read. The class has no SFML dependency; glyph
+ * metrics come from a caller-supplied function.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef TREE_GEOMETRY_HPP
+#define TREE_GEOMETRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "key_format.hpp"
+#include "layout.hpp"
+
+/**
+ * @brief An RGBA color.
+ */
+struct RGBA {
+    std::uint8_t r; ///< Red.
+    std::uint8_t g; ///< Green.
+    std::uint8_t b; ///< Blue.
+    std::uint8_t a; ///< Alpha.
+};
+
+/**
+ * @brief A vertex with position, color and texture coordinates.
+ */
+struct GeometryVertex {
+    float x;    ///< Horizontal position.
+    float y;    ///< Vertical position.
+    RGBA color; ///< Vertex color.
+    float u;    ///< Horizontal texture coordinate in texels.
+    float v;    ///< Vertical texture coordinate in texels.
+};
+
+/**
+ * @brief The placement of one glyph of a font, relative to the pen position on the baseline.
+ */
+struct GlyphMetrics {
+    float advance;    ///< Horizontal distance to the next glyph.
+    float left;       ///< Left edge of the glyph box.
+    float top;        ///< Top edge of the glyph box (negative above the baseline).
+    float width;      ///< Width of the glyph box.
+    float height;     ///< Height of the glyph box.
+    float tex_left;   ///< Left edge of the glyph in the font texture.
+    float tex_top;    ///< Top edge of the glyph in the font texture.
+    float tex_width;  ///< Width of the glyph in the font texture.
+    float tex_height; ///< Height of the glyph in the font texture.
+};
+
+/**
+ * @class TreeGeometry
+ * @brief Edge, disc and label vertex batches for a laid-out tree.
+ *
+ * @tparam NodeType The node type of the tree.
+ */
+template <typename NodeType>
+class TreeGeometry {
+public:
+    /**
+     * @brief The look of the drawn tree.
+     */
+    struct Style {
+        float node_radius;  ///< Radius of the node discs.
+        unsigned text_size; ///< Character size of the labels, also the baseline offset.
+        RGBA edge_color;    ///< Color of the edges.
+        RGBA disc_color;    ///< Color of the discs.
+        RGBA text_color;    ///< Color of the labels.
+    };
+
+    /**
+     * @brief The visible part of the drawing.
+     */
+    struct Viewport {
+        typename TreeLayout<NodeType>::Box area; ///< The visible area in drawing coordinates.
+        float scale;                             ///< Pixels per drawing unit.
+    };
+
+    static constexpr float MIN_LABEL_PIXELS = 4; ///< Smallest drawn character size in pixels.
+
+    /**
+     * @brief Construct empty batches.
+     *
+     * @param style The look of the drawn tree.
+     */
+    explicit TreeGeometry(const Style& style)
+        : look(style), built_view(everything()), built_version(0), built(false), rebuilds(0),
+          aggregates(0) {
+        glyphs.resize(256);
+        known.assign(256, false);
+    }
+
+    /**
+     * @brief Rebuild the batches of the whole tree if the layout changed since the last rebuild.
+     *
+     * Each label is placed like the demo's sf::Text: its origin is half a radius up and left of
+     * the node centre.
+     *
+     * @param layout The layout of the tree.
+     * @param glyph A function returning the GlyphMetrics of a character, called once per
+     * distinct character over the lifetime of the geometry.
+     * @return true If the batches were rebuilt.
+     * @return false If they were already up to date.
+     */
+    template <typename GlyphSource>
+    bool update(TreeLayout<NodeType>& layout, GlyphSource glyph) {
+        return update(layout, everything(), glyph);
+    }
+
+    /**
+     * @brief Rebuild the batches of the visible nodes if the layout or the viewport changed.
+     *
+     * @param layout The layout of the tree.
+     * @param view The visible part of the drawing.
+     * @param glyph A function returning the GlyphMetrics of a character.
+     * @return true If the batches were rebuilt.
+     * @return false If they were already up to date.
+     */
+    template <typename GlyphSource>
+    bool update(TreeLayout<NodeType>& layout, const Viewport& view, GlyphSource glyph) {
+        if (built && built_version == layout.version() && same(built_view, view)) return false;
+        edge_vertices.clear();
+        disc_vertices.clear();
+        label_vertices.clear();
+        aggregates = 0;
+        bool labels = look.text_size * view.scale >= MIN_LABEL_PIXELS;
+        typedef typename TreeLayout<NodeType>::Point Point;
+        typedef typename TreeLayout<NodeType>::Box Box;
+        layout.for_each_in(view.area, look.node_radius, 1 / view.scale,
+            [this, labels, &glyph](NodeType& node, const Point& p, const Point& parent) {
+                if (&p != &parent) add_edge(parent, p);
+                add_disc(p.x, p.y);
+                if (labels) {
+                    label.clear();
+                    append_key(label, node.get_key());
+                    add_label(p.x - look.node_radius / 2, p.y - look.node_radius / 2, glyph);
+                }
+            },
+            [this](NodeType&, const Box& box, const Point& parent) {
+                Point top = {(box.left + box.right) / 2, box.top + look.node_radius};
+                if (parent.x != top.x || parent.y != top.y) add_edge(parent, top);
+                float r = look.node_radius;
+                add_quad(disc_vertices, box.left, box.top, box.right, box.bottom, r, r, r, r,
+                         look.disc_color);
+                ++aggregates;
+            });
+        built = true;
+        built_version = layout.version();
+        built_view = view;
+        ++rebuilds;
+        return true;
+    }
+
+    /**
+     * @brief Get the edge batch.
+     *
+     * @return const std::vector<GeometryVertex>& Two vertices per edge, for a line list.
+     */
+    const std::vector<GeometryVertex>& edges() const { return edge_vertices; }
+
+    /**
+     * @brief Get the disc batch.
+     *
+     * The texture coordinates of each disc span a square of twice the node radius, so the
+     * batch is drawn with a texture holding one disc of that size. Aggregate quads all sample
+     * the centre of that texture and so come out solid.
+     *
+     * @return const std::vector<GeometryVertex>& Six textured vertices per node or aggregate,
+     * for a triangle list.
+     */
+    const std::vector<GeometryVertex>& discs() const { return disc_vertices; }
+
+    /**
+     * @brief Get the label batch.
+     *
+     * @return const std::vector<GeometryVertex>& Six textured vertices per glyph, for a triangle
+     * list.
+     */
+    const std::vector<GeometryVertex>& labels() const { return label_vertices; }
+
+    /**
+     * @brief Get the number of times the batches were rebuilt.
+     *
+     * @return std::size_t The rebuild count.
+     */
+    std::size_t rebuild_count() const { return rebuilds; }
+
+    /**
+     * @brief Get the number of collapsed subtrees in the current batches.
+     *
+     * @return std::size_t The aggregate count.
+     */
+    std::size_t aggregate_count() const { return aggregates; }
+
+private:
+    Style look;                                 ///< The look of the drawn tree.
+    std::vector<GlyphMetrics> glyphs;           ///< Cached glyph metrics by character.
+    std::vector<bool> known;                    ///< Whether a character's metrics are cached.
+    std::vector<GeometryVertex> edge_vertices;  ///< Edge batch.
+    std::vector<GeometryVertex> disc_vertices;  ///< Disc batch.
+    std::vector<GeometryVertex> label_vertices; ///< Label batch.
+    std::string label;                          ///< Reused label text.
+    Viewport built_view;                        ///< Viewport of the current batches.
+    std::size_t built_version;                  ///< Layout version of the current batches.
+    bool built;                                 ///< Whether the batches were ever built.
+    std::size_t rebuilds;                       ///< Number of rebuilds.
+    std::size_t aggregates;                     ///< Collapsed subtrees in the current batches.
+
+    /**
+     * @brief Get a viewport that shows the whole drawing at full detail.
+     *
+     * @return Viewport An unbounded area at an unbounded scale.
+     */
+    static Viewport everything() {
+        float inf = std::numeric_limits<float>::infinity();
+        Viewport view = {{-inf, -inf, inf, inf}, inf};
+        return view;
+    }
+
+    /**
+     * @brief Compare two viewports.
+     *
+     * @param a The first viewport.
+     * @param b The second viewport.
+     * @return true If they show the same area at the same scale.
+     * @return false Otherwise.
+     */
+    static bool same(const Viewport& a, const Viewport& b) {
+        return a.area.left == b.area.left && a.area.top == b.area.top &&
+               a.area.right == b.area.right && a.area.bottom == b.area.bottom &&
+               a.scale == b.scale;
+    }
+
+    /**
+     * @brief Make an untextured vertex.
+     *
+     * @param x The horizontal position.
+     * @param y The vertical position.
+     * @param color The color.
+     * @return GeometryVertex The vertex.
+     */
+    static GeometryVertex vertex(float x, float y, RGBA color) {
+        GeometryVertex v = {x, y, color, 0, 0};
+        return v;
+    }
+
+    /**
+     * @brief Append an edge.
+     *
+     * @param from The parent end.
+     * @param to The child end.
+     */
+    void add_edge(const typename TreeLayout<NodeType>::Point& from,
+                  const typename TreeLayout<NodeType>::Point& to) {
+        edge_vertices.push_back(vertex(from.x, from.y, look.edge_color));
+        edge_vertices.push_back(vertex(to.x, to.y, look.edge_color));
+    }
+
+    /**
+     * @brief Append a textured quad as two triangles.
+     *
+     * @param batch The batch to append to.
+     * @param left The left edge.
+     * @param top The top edge.
+     * @param right The right edge.
+     * @param bottom The bottom edge.
+     * @param u0 The left texture coordinate.
+     * @param v0 The top texture coordinate.
+     * @param u1 The right texture coordinate.
+     * @param v1 The bottom texture coordinate.
+     * @param color The vertex color.
+     */
+    static void add_quad(std::vector<GeometryVertex>& batch, float left, float top, float right,
+                         float bottom, float u0, float v0, float u1, float v1, RGBA color) {
+        GeometryVertex a = {left, top, color, u0, v0};
+        GeometryVertex b = {right, top, color, u1, v0};
+        GeometryVertex c = {right, bottom, color, u1, v1};
+        GeometryVertex d = {left, bottom, color, u0, v1};
+        batch.push_back(a);
+        batch.push_back(b);
+        batch.push_back(c);
+        batch.push_back(a);
+        batch.push_back(c);
+        batch.push_back(d);
+    }
+
+    /**
+     * @brief Append the quad of one disc.
+     *
+     * @param x The horizontal centre.
+     * @param y The vertical centre.
+     */
+    void add_disc(float x, float y) {
+        float r = look.node_radius;
+        add_quad(disc_vertices, x - r, y - r, x + r, y + r, 0, 0, 2 * r, 2 * r, look.disc_color);
+    }
+
+    /**
+     * @brief Append the glyph quads of the current label.
+     *
+     * @param x The horizontal origin of the label.
+     * @param y The vertical origin of the label.
+     * @param glyph The glyph metrics source.
+     */
+    template <typename GlyphSource>
+    void add_label(float x, float y, GlyphSource& glyph) {
+        float pen = x;
+        float baseline = y + static_cast<float>(look.text_size);
+        for (char c : label) {
+            unsigned char code = static_cast<unsigned char>(c);
+            if (!known[code]) {
+                glyphs[code] = glyph(code);
+                known[code] = true;
+            }
+            const GlyphMetrics& g = glyphs[code];
+            float left = pen + g.left;
+            float top = baseline + g.top;
+            add_quad(label_vertices, left, top, left + g.width, top + g.height, g.tex_left,
+                     g.tex_top, g.tex_left + g.tex_width, g.tex_top + g.tex_height,
+                     look.text_color);
+            pen += g.advance;
+        }
+    }
+};
+
+template <typename NodeType>
+constexpr float TreeGeometry<NodeType>::MIN_LABEL_PIXELS;
+
+#endif // TREE_GEOMETRY_HPP
@@ -0,0 +1,436 @@
+/**
+ * @file tree_stats.hpp
+ * @brief Declaration of the TreeStats counters, compiled into Tree when TREE_STATS is defined.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains the optional instrumentation of the Tree class. With TREE_STATS defined,
+ * every tree keeps a TreeStats object that counts the nodes find_node visits, records how
+ * many nodes each add_sub_node search visited, how large the stack, queue or heap of each of
+ * the six iterators grew during a traversal, and how many add_sub_node and emplace_sub_node
+ * calls failed because the parent was missing or already had k children. The counters can be
+ * written as text or JSON. Without TREE_STATS the tree uses NoTreeStats, whose functions are
+ * empty and whose iterator probe is an empty base class, so the hooks compile to nothing and
+ * no iterator grows.
+ *
+ * The counters are plain integers and are not synchronized; concurrent traversals of one tree
+ * in a TREE_STATS build may lose counts.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef TREE_STATS_HPP
+#define TREE_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief The iterators whose stack, queue or heap sizes are recorded.
+ */
+enum class IteratorKind { BFS, DFS, InOrder, PostOrder, PreOrder, MinHeap };
+
+/**
+ * @brief The reasons an add_sub_node or emplace_sub_node call returns nullptr.
+ */
+enum class AddFailure { MissingParent, FullParent };
+
+/**
+ * @class StatsHistogram
+ * @brief A histogram of non-negative values in power-of-two buckets.
+ *
+ * Bucket 0 counts the value 0 and bucket b counts the values from 2^(b-1) to 2^b - 1.
+ */
+class StatsHistogram {
+public:
+    static const std::size_t BUCKETS = 65; ///< Number of buckets, enough for any 64-bit value.
+
+    /**
+     * @brief Construct an empty histogram.
+     */
+    StatsHistogram() : samples(0), total(0), largest(0) {
+        for (std::size_t b = 0; b < BUCKETS; ++b) counts[b] = 0;
+    }
+
+    /**
+     * @brief Record a value.
+     *
+     * @param value The value.
+     */
+    void record(std::uint64_t value) {
+        ++counts[bucket(value)];
+        ++samples;
+        total += value;
+        if (value > largest) largest = value;
+    }
+
+    /**
+     * @brief Get the number of recorded values.
+     *
+     * @return std::uint64_t The sample count.
+     */
+    std::uint64_t count() const { return samples; }
+
+    /**
+     * @brief Get the sum of the recorded values.
+     *
+     * @return std::uint64_t The sum.
+     */
+    std::uint64_t sum() const { return total; }
+
+    /**
+     * @brief Get the largest recorded value.
+     *
+     * @return std::uint64_t The maximum, 0 if nothing was recorded.
+     */
+    std::uint64_t max() const { return largest; }
+
+    /**
+     * @brief Get the number of values in a bucket.
+     *
+     * @param b The bucket.
+     * @return std::uint64_t The count.
+     */
+    std::uint64_t bucket_count(std::size_t b) const { return counts[b]; }
+
+    /**
+     * @brief Get the bucket of a value.
+     *
+     * @param value The value.
+     * @return std::size_t The bucket, the number of significant bits of the value.
+     */
+    static std::size_t bucket(std::uint64_t value) {
+        std::size_t b = 0;
+        for (; value != 0; value >>= 1) ++b;
+        return b;
+    }
+
+    /**
+     * @brief Get the smallest value of a bucket.
+     *
+     * @param b The bucket.
+     * @return std::uint64_t The lower bound.
+     */
+    static std::uint64_t bucket_low(std::size_t b) { return b == 0 ? 0 : std::uint64_t(1) << (b - 1); }
+
+    /**
+     * @brief Get the largest value of a bucket.
+     *
+     * @param b The bucket.
+     * @return std::uint64_t The upper bound.
+     */
+    static std::uint64_t bucket_high(std::size_t b) { return b == 0 ? 0 : bucket_low(b) * 2 - 1; }
+
+    /**
+     * @brief Write a summary line and one line per non-empty bucket.
+     *
+     * @param os The output stream.
+     * @param name The name of the histogram.
+     */
+    void write_text(std::ostream& os, const char* name) const {
+        os << name << ": " << samples << " samples, mean " << (samples ? double(total) / samples : 0.0)
+           << ", max " << largest << "\n";
+        for (std::size_t b = 0; b < BUCKETS; ++b) {
+            if (counts[b] == 0) continue;
+            os << "  " << bucket_low(b);
+            if (bucket_high(b) != bucket_low(b)) os << "-" << bucket_high(b);
+            os << ": " << counts[b] << "\n";
+        }
+    }
+
+    /**
+     * @brief Write the histogram as a JSON object.
+     *
+     * @param os The output stream.
+     */
+    void write_json(std::ostream& os) const {
+        os << "{\"count\": " << samples << ", \"sum\": " << total << ", \"max\": " << largest << ", \"buckets\": [";
+        const char* separator = "";
+        for (std::size_t b = 0; b < BUCKETS; ++b) {
+            if (counts[b] == 0) continue;
+            os << separator << "[" << bucket_low(b) << ", " << bucket_high(b) << ", " << counts[b] << "]";
+            separator = ", ";
+        }
+        os << "]}";
+    }
+
+private:
+    std::uint64_t counts[BUCKETS]; ///< Values per bucket.
+    std::uint64_t samples;         ///< Number of values.
+    std::uint64_t total;           ///< Sum of the values.
+    std::uint64_t largest;         ///< Largest value.
+};
+
+/**
+ * @class TreeStats
+ * @brief The counters of one tree.
+ */
+class TreeStats {
+public:
+    static const bool enabled = true;        ///< Whether the counters are collected.
+    static const std::size_t ITERATOR_KINDS = 6; ///< Number of IteratorKind values.
+
+    /**
+     * @class Probe
+     * @brief Tracks the largest frontier of one traversal and reports it when the traversal ends.
+     *
+     * Iterators inherit from the probe. A traversal abandoned before its end is not reported.
+     */
+    class Probe {
+    public:
+        /**
+         * @brief Construct a probe that reports nowhere, for end iterators.
+         */
+        Probe() : stats(nullptr), kind(IteratorKind::BFS), peak(0) {}
+
+        /**
+         * @brief Construct a probe for a traversal.
+         *
+         * @param stats The counters to report to, or nullptr.
+         * @param kind The iterator.
+         */
+        Probe(TreeStats* stats, IteratorKind kind) : stats(stats), kind(kind), peak(0) {}
+
+        /**
+         * @brief Note the current size of the iterator's stack, queue or heap, and report the
+         * largest size once it is empty, which ends the traversal.
+         *
+         * @param size The size.
+         */
+        void track(std::size_t size) {
+            if (size > peak) peak = size;
+            if (size == 0 && stats) {
+                stats->frontier[static_cast<std::size_t>(kind)].record(peak);
+                stats = nullptr;
+            }
+        }
+
+    private:
+        TreeStats* stats;  ///< Counters to report to, null once reported.
+        IteratorKind kind; ///< The iterator.
+        std::size_t peak;  ///< Largest size seen.
+    };
+
+    /**
+     * @brief Construct zeroed counters.
+     */
+    TreeStats() : visits(0), missing_parent(0), full_parent(0) {}
+
+    /**
+     * @brief Count the nodes visited by one find_node call.
+     *
+     * @param count The visit count.
+     */
+    void count_find_visits(std::uint64_t count) { visits += count; }
+
+    /**
+     * @brief Get the number of nodes visited by find_node.
+     *
+     * @return std::uint64_t The visit count.
+     */
+    std::uint64_t find_visits() const { return visits; }
+
+    /**
+     * @brief Record how many nodes the parent search of one add_sub_node call visited.
+     *
+     * @param count The visit count.
+     */
+    void record_insert_search(std::uint64_t count) { insert_search.record(count); }
+
+    /**
+     * @brief Count a failed add_sub_node or emplace_sub_node call.
+     *
+     * @param reason Why it failed.
+     */
+    void count_failed_add(AddFailure reason) {
+        ++(reason == AddFailure::MissingParent ? missing_parent : full_parent);
+    }
+
+    /**
+     * @brief Get the number of failed add_sub_node and emplace_sub_node calls.
+     *
+     * @param reason Why they failed.
+     * @return std::uint64_t The count.
+     */
+    std::uint64_t failed_adds(AddFailure reason) const {
+        return reason == AddFailure::MissingParent ? missing_parent : full_parent;
+    }
+
+    /**
+     * @brief Get the parent-search histogram of add_sub_node.
+     *
+     * @return const StatsHistogram& Nodes visited per call that searched with find_node.
+     */
+    const StatsHistogram& insert_searches() const { return insert_search; }
+
+    /**
+     * @brief Get the frontier histogram of an iterator.
+     *
+     * @param kind The iterator.
+     * @return const StatsHistogram& The largest stack, queue or heap size of each completed traversal.
+     */
+    const StatsHistogram& iterator_frontier(IteratorKind kind) const {
+        return frontier[static_cast<std::size_t>(kind)];
+    }
+
+    /**
+     * @brief Write the counters as text.
+     *
+     * @param os The output stream.
+     */
+    void write_text(std::ostream& os) const {
+        os << "find_node visits: " << visits << "\n";
+        os << "failed adds: " << missing_parent << " missing parent, " << full_parent << " full parent\n";
+        insert_search.write_text(os, "add_sub_node search visits");
+        for (std::size_t i = 0; i < ITERATOR_KINDS; ++i) {
+            frontier[i].write_text(os, (std::string(kind_name(i)) + " frontier").c_str());
+        }
+    }
+
+    /**
+     * @brief Write the counters as a JSON object.
+     *
+     * @param os The output stream.
+     */
+    void write_json(std::ostream& os) const {
+        os << "{\"enabled\": true, \"find_node_visits\": " << visits << ", \"failed_adds\": {\"missing_parent\": "
+           << missing_parent << ", \"full_parent\": " << full_parent << "}, \"add_sub_node_search_visits\": ";
+        insert_search.write_json(os);
+        os << ", \"iterator_frontier\": {";
+        for (std::size_t i = 0; i < ITERATOR_KINDS; ++i) {
+            os << (i ? ", " : "") << "\"" << kind_name(i) << "\": ";
+            frontier[i].write_json(os);
+        }
+        os << "}}";
+    }
+
+private:
+    std::uint64_t visits;                    ///< Nodes visited by find_node.
+    std::uint64_t missing_parent;            ///< Adds whose parent key was not found.
+    std::uint64_t full_parent;               ///< Adds whose parent already had k children.
+    StatsHistogram insert_search;            ///< Nodes visited per add_sub_node parent search.
+    StatsHistogram frontier[ITERATOR_KINDS]; ///< Largest frontier per traversal, by iterator.
+
+    /**
+     * @brief Get the name of an iterator.
+     *
+     * @param i The IteratorKind value.
+     * @return const char* The name.
+     */
+    static const char* kind_name(std::size_t i) {
+        static const char* const names[ITERATOR_KINDS] = {"bfs", "dfs", "in_order", "post_order", "pre_order", "min_heap"};
+        return names[i];
+    }
+};
+
+/**
+ * @class NoTreeStats
+ * @brief The counters of a tree built without TREE_STATS: every function does nothing.
+ */
+class NoTreeStats {
+public:
+    static const bool enabled = false; ///< Whether the counters are collected.
+
+    /**
+     * @brief An empty probe.
+     */
+    class Probe {
+    public:
+        /**
+         * @brief Construct a probe that reports nothing.
+         */
+        Probe() {}
+
+        /**
+         * @brief Construct a probe that ignores its counters and iterator kind.
+         */
+        Probe(NoTreeStats*, IteratorKind) {}
+
+        /**
+         * @brief Ignore the current container size.
+         */
+        void track(std::size_t) {}
+    };
+
+    /**
+     * @brief Ignore the nodes visited by one find_node call.
+     */
+    void count_find_visits(std::uint64_t) {}
+
+    /**
+     * @brief Get the number of nodes visited by find_node, always 0.
+     *
+     * @return std::uint64_t 0.
+     */
+    std::uint64_t find_visits() const { return 0; }
+
+    /**
+     * @brief Ignore the cost of an insertion's parent search.
+     */
+    void record_insert_search(std::uint64_t) {}
+
+    /**
+     * @brief Ignore a failed insertion.
+     */
+    void count_failed_add(AddFailure) {}
+
+    /**
+     * @brief Write a note that the counters are disabled.
+     *
+     * @param os The output stream.
+     */
+    void write_text(std::ostream& os) const { os << "tree stats disabled (build with -DTREE_STATS)\n"; }
+
+    /**
+     * @brief Write a JSON object saying the counters are disabled.
+     *
+     * @param os The output stream.
+     */
+    void write_json(std::ostream& os) const { os << "{\"enabled\": false}"; }
+};
+
+/**
+ * @class TreeStatsHolder
+ * @brief The base class through which a tree holds its counters.
+ *
+ * Counters are updated from const traversals, so they are kept mutable.
+ *
+ * @tparam Stats The counters type.
+ */
+template <typename Stats>
+class TreeStatsHolder {
+protected:
+    /**
+     * @brief Get the counters.
+     *
+     * @return Stats& The counters.
+     */
+    Stats& counters() const { return stats; }
+
+private:
+    mutable Stats stats; ///< The counters.
+};
+
+/**
+ * @brief The holder of disabled counters, an empty base class that adds nothing to a tree.
+ */
+template <>
+class TreeStatsHolder<NoTreeStats> : private NoTreeStats {
+protected:
+    /**
+     * @brief Get the counters, which have no state to change.
+     *
+     * @return NoTreeStats& The counters.
+     */
+    NoTreeStats& counters() const { return *const_cast<TreeStatsHolder*>(this); }
+};
+
+#ifdef TREE_STATS
+typedef TreeStats ActiveTreeStats; ///< The counters compiled into Tree.
+#else
+typedef NoTreeStats ActiveTreeStats; ///< The counters compiled into Tree.
+#endif
+
+#endif // TREE_STATS_HPP
@@ -0,0 +1,238 @@
+/**
+ * @file tree_svg.hpp
+ * @brief Declaration of the write_svg and save_svg functions for headless tree rendering.
+ * @date 2026-10-15
+ * @version 1.0
+ * @details
+ * This file contains an SVG writer that draws a laid-out tree the way the SFML demo does, with
+ * no display and no SFML dependency, so trees can be rendered in batch jobs on machines
+ * without a window system. All edges go into a single path element, followed by one circle
+ * and one text element per node. Coordinates are written with one decimal and keys with
+ * format_key, through a BlockWriter, so no number or label passes through stream formatting.
+ *
+ * Contact: wasimshebalny@gmail.com
+ */
+
+#ifndef TREE_SVG_HPP
+#define TREE_SVG_HPP
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include "key_format.hpp"
+#include "layout.hpp"
+#include "text_io.hpp"
+
+/**
+ * @brief The look of a tree drawn as SVG; colors are SVG color strings.
+ */
+struct SvgStyle {
+    float node_radius;      ///< Radius of the node discs.
+    unsigned text_size;     ///< Font size of the labels, also the baseline offset.
+    const char* background; ///< Fill of the background, or nullptr for none.
+    const char* edge_color; ///< Stroke of the edges.
+    const char* disc_color; ///< Fill of the discs.
+    const char* text_color; ///< Fill of the labels.
+};
+
+namespace tree_svg_detail {
+
+/**
+ * @brief Append a string.
+ *
+ * @param out The buffer.
+ * @param text The text.
+ */
+inline void put(BlockWriter& out, const char* text) {
+    out.sputn(text, static_cast<std::streamsize>(std::strlen(text)));
+}
+
+/**
+ * @brief Append a coordinate with at most one decimal.
+ *
+ * @param out The buffer.
+ * @param value The coordinate.
+ * @throws std::invalid_argument If the coordinate is not finite or too large to write.
+ */
+inline void put(BlockWriter& out, float value) {
+    char text[32];
+    double scaled = static_cast<double>(value) * 10;
+    // llround is undefined outside the range of long long, and NaN compares false here
+    if (!(std::fabs(scaled) < 9e18)) throw std::invalid_argument("svg: coordinate out of range");
+    long long tenths = std::llround(scaled);
+    char* first = text;
+    if (tenths < 0) {
+        *first++ = '-';
+        tenths = -tenths;
+    }
+    char* end = format_key(first, text + sizeof(text) - 2, tenths / 10);
+    if (tenths % 10 != 0) {
+        *end++ = '.';
+        *end++ = static_cast<char>('0' + tenths % 10);
+    }
+    out.sputn(text, end - text);
+}
+
+/**
+ * @brief Append an attribute with a string value.
+ *
+ * @param out The buffer.
+ * @param name The attribute name.
+ * @param value The value.
+ */
+inline void attribute(BlockWriter& out, const char* name, const char* value) {
+    out.put(' ');
+    put(out, name);
+    put(out, "=\"");
+    put(out, value);
+    out.put('"');
+}
+
+/**
+ * @brief Append an attribute with a coordinate value.
+ *
+ * @param out The buffer.
+ * @param name The attribute name.
+ * @param value The value.
+ */
+inline void attribute(BlockWriter& out, const char* name, float value) {
+    out.put(' ');
+    put(out, name);
+    put(out, "=\"");
+    put(out, value);
+    out.put('"');
+}
+
+/**
+ * @brief Append label text, escaping the characters that are special in XML.
+ *
+ * @param out The buffer.
+ * @param text The label.
+ */
+inline void put_escaped(BlockWriter& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+        case '&': put(out, "&amp;"); break;
+        case '<': put(out, "&lt;"); break;
+        case '>': put(out, "&gt;"); break;
+        default: out.put(c);
+        }
+    }
+}
+
+} // namespace tree_svg_detail
+
+/**
+ * @brief Draw a laid-out tree as an SVG document.
+ *
+ * The document's view box is the extent of the layout, so the tree is drawn at one SVG unit
+ * per layout unit. Labels are placed like the demo's sf::Text, with the baseline one font size
+ * below a point half a radius up and left of the node centre.
+ *
+ * @param out The output stream.
+ * @param layout The layout of the tree.
+ * @param style The look of the drawing.
+ * @throws std::invalid_argument If a coordinate is not finite or too large to write; the part
+ * of the document before it has already been written.
+ * @throws std::runtime_error If writing fails.
+ */
+template <typename NodeType>
+void write_svg(std::ostream& out, TreeLayout<NodeType>& layout, const SvgStyle& style) {
+    using tree_svg_detail::attribute;
+    using tree_svg_detail::put;
+    typedef typename TreeLayout<NodeType>::Point Point;
+    typename TreeLayout<NodeType>::Box box = layout.extent(style.node_radius);
+    float width = box.right - box.left, height = box.bottom - box.top;
+    {
+        BlockWriter svg(out);
+        put(svg, "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+        put(svg, box.left);
+        svg.put(' ');
+        put(svg, box.top);
+        svg.put(' ');
+        put(svg, width);
+        svg.put(' ');
+        put(svg, height);
+        svg.put('"');
+        attribute(svg, "width", width);
+        attribute(svg, "height", height);
+        put(svg, ">\n");
+        if (style.background) {
+            put(svg, "<rect");
+            attribute(svg, "x", box.left);
+            attribute(svg, "y", box.top);
+            attribute(svg, "width", width);
+            attribute(svg, "height", height);
+            attribute(svg, "fill", style.background);
+            put(svg, "/>\n");
+        }
+
+        put(svg, "<path");
+        attribute(svg, "fill", "none");
+        attribute(svg, "stroke", style.edge_color);
+        put(svg, " d=\"");
+        layout.for_each([&svg](NodeType&, const Point& p, const Point& parent) {
+            if (&p == &parent) return;
+            svg.put('M');
+            put(svg, parent.x);
+            svg.put(' ');
+            put(svg, parent.y);
+            svg.put('L');
+            put(svg, p.x);
+            svg.put(' ');
+            put(svg, p.y);
+        });
+        put(svg, "\"/>\n<g");
+        attribute(svg, "fill", style.disc_color);
+        put(svg, ">\n");
+        layout.for_each([&svg, &style](NodeType&, const Point& p, const Point&) {
+            put(svg, "<circle");
+            attribute(svg, "cx", p.x);
+            attribute(svg, "cy", p.y);
+            attribute(svg, "r", style.node_radius);
+            put(svg, "/>\n");
+        });
+        put(svg, "</g>\n<g");
+        attribute(svg, "fill", style.text_color);
+        attribute(svg, "font-family", "DejaVu Sans");
+        attribute(svg, "font-size", static_cast<float>(style.text_size));
+        put(svg, ">\n");
+        std::string label;
+        float shift = style.node_radius / 2;
+        layout.for_each([&svg, &style, &label, shift](NodeType& node, const Point& p, const Point&) {
+            label.clear();
+            append_key(label, node.get_key());
+            put(svg, "<text");
+            attribute(svg, "x", p.x - shift);
+            attribute(svg, "y", p.y - shift + static_cast<float>(style.text_size));
+            svg.put('>');
+            tree_svg_detail::put_escaped(svg, label);
+            put(svg, "</text>\n");
+        });
+        put(svg, "</g>\n</svg>\n");
+    }
+    if (!out) throw std::runtime_error("svg: write failed");
+}
+
+/**
+ * @brief Draw a laid-out tree into an SVG file.
+ *
+ * @param path The file path; an existing file is replaced.
+ * @param layout The layout of the tree.
+ * @param style The look of the drawing.
+ * @throws std::invalid_argument If a coordinate is not finite or too large to write.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+template <typename NodeType>
+void save_svg(const std::string& path, TreeLayout<NodeType>& layout, const SvgStyle& style) {
+    std::ofstream out(path.c_str(), std::ios::trunc);
+    if (!out) throw std::runtime_error("svg: cannot open " + path);
+    write_svg(out, layout, style);
+    out.close();
+    if (!out) throw std::runtime_error("svg: write failed for " + path);
+}
+
+#endif // TREE_SVG_HPP